@@ -0,0 +1,33 @@
+#include <iostream>
+#include "requirecpp/requirecpp.hpp"
+
+// Typical translation unit using requirecpp, compiled once against the
+// header-only library and once against requirecpp_compiled. Compare the
+// build times of both targets, e.g.
+//   cmake --build . --target bench_build-time-header-only -- -B
+//   cmake --build . --target bench_build-time-compiled -- -B
+
+class Config {};
+class Db {};
+class Cache {};
+class Server {};
+
+int main() {
+  requirecpp::Context context;
+  context.require(
+      [&](const Config&, std::shared_ptr<Db>, Cache*) {
+        context.emplace<Server>();
+      },
+      "start", 10);
+  context.require_for([](const Server&) {}, std::chrono::seconds{1},
+                      [](const std::string& decl) { std::cout << decl; },
+                      "serve");
+  context.emplace<Config>();
+  context.emplace<Db>();
+  context.emplace<Cache>();
+  context.print_pending();
+  auto [db, server] = context.get_all<Db, Server>();
+  std::cout << context.stats().objects << " objects" << std::endl;
+  context.remove<Cache>();
+  return db && server ? 0 : 1;
+}
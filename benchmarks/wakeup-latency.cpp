@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "requirecpp/requirecpp.hpp"
+
+// Wake-up latency of threads blocked in get<T>()->require() when T is
+// published, depending on the number of waiting threads.
+
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+class Db {};
+
+int main() {
+  constexpr int rounds = 20;
+  std::cout << "waiters  avg_us   max_us" << std::endl;
+  for (int waiters : {1, 2, 4, 8, 16, 32, 64}) {
+    double sum_us = 0;
+    double max_us = 0;
+    for (int round = 0; round < rounds; ++round) {
+      requirecpp::Context context;
+      std::vector<Clock::time_point> woken(waiters);
+      std::atomic<int> blocked{0};
+      {
+        std::vector<std::jthread> threads;
+        for (int i = 0; i < waiters; ++i) {
+          threads.emplace_back([&, i] {
+            auto db = context.get<Db>();
+            ++blocked;
+            db->require();
+            woken[i] = Clock::now();
+          });
+        }
+        while (blocked < waiters) {
+          std::this_thread::yield();
+        }
+        // give all threads time to actually block
+        std::this_thread::sleep_for(1ms);
+        const auto published = Clock::now();
+        context.emplace<Db>();
+        threads.clear();
+        for (const auto& t : woken) {
+          const double us =
+              std::chrono::duration<double, std::micro>(t - published).count();
+          sum_us += us;
+          max_us = std::max(max_us, us);
+        }
+      }
+    }
+    std::cout << waiters << "\t " << sum_us / (waiters * rounds) << "\t  "
+              << max_us << std::endl;
+  }
+}
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
 
 namespace requirecpp::decorator {
 
@@ -12,45 +14,84 @@ struct Tagged {
   std::shared_ptr<T> object;
 };
 
-// TODO locking! object must not be in use!
+// Object that can be recreated while other threads use it. Users hold the
+// shared_ptr returned by get_object() as read guard, the replaced instance is
+// destroyed when the last of them releases it.
 template <typename T>
 class Restartable {
  public:
   template <typename... Args>
   Restartable(Args&&... args)
-      : m_object{std::make_unique<T>(std::forward<Args>(args)...)} {}
+      : m_object{std::make_shared<T>(std::forward<Args>(args)...)} {}
   // Restartable(std::unique_ptr<T> object) : m_object{std::move(object)} {}
+  Restartable(const Restartable&) = delete;
+  Restartable(Restartable&&) = delete;
+  Restartable& operator=(const Restartable&) = delete;
+  Restartable& operator=(Restartable&&) = delete;
+  ~Restartable() = default;
+
+  // hooks are called without holding the restart lock, they may use this
+  // Restartable again. Hooks of concurrent restarts may interleave.
   template <typename Fn>
   void on_start(Fn&& fn) {
-    if (m_object) {
-      fn();
+    std::function<void()> hook{std::forward<Fn>(fn)};
+    bool running;
+    {
+      std::scoped_lock lk{m_restart_mutex};
+      m_funcs_start.emplace_back(hook);
+      running = m_object.load() != nullptr;
+    }
+    if (running) {
+      hook();
     }
-    m_funcs_start.emplace(std::forward<Fn>(fn));
   }
+
   template <typename Fn>
   void before_stop(Fn&& fn) {
-    m_funcs_stop.emplace(std::forward<Fn>(fn));
+    std::scoped_lock lk{m_restart_mutex};
+    m_funcs_stop.emplace_back(std::forward<Fn>(fn));
   }
-  T& get_object() { return m_object; }
-  const T& get_object() const { return m_object; }
+
+  // non blocking, may return nullptr after reset()
+  std::shared_ptr<T> get_object() const { return m_object.load(); }
 
   void reset() {
-    if (m_object) {
-      std::ranges::for_each(m_funcs_stop, [](auto& fn) { fn(); });
-    }
-    m_object.reset();
+    stop();
+    m_object.store(nullptr);
   }
 
   template <typename... Args>
   void recreate(Args&&... args) {
-    reset();
-    m_object = std::make_unique<T>(std::forward<Args>(args)...);
-    std::ranges::for_each(m_funcs_start, [](auto& fn) { fn(); });
+    // build the replacement before stopping the running instance
+    auto replacement = std::make_shared<T>(std::forward<Args>(args)...);
+    stop();
+    m_object.store(std::move(replacement));
+    for (auto& fn : hooks(m_funcs_start)) {
+      fn();
+    }
   }
 
  private:
-  std::unique_ptr<T> m_object;
-  std::deque<std::function<void()>> m_funcs_start;
-  std::deque<std::function<void()>> m_funcs_stop;
+  using Hooks = std::deque<std::function<void()>>;
+
+  Hooks hooks(const Hooks& funcs) {
+    std::scoped_lock lk{m_restart_mutex};
+    return funcs;
+  }
+
+  void stop() {
+    if (m_object.load()) {
+      for (auto& fn : hooks(m_funcs_stop)) {
+        fn();
+      }
+    }
+  }
+
+ private:
+  std::atomic<std::shared_ptr<T>> m_object;
+  std::mutex m_restart_mutex;
+  Hooks m_funcs_start;
+  Hooks m_funcs_stop;
 };
+
 }  // namespace requirecpp::decorator
@@ -1,8 +1,13 @@
 #pragma once
+#include <array>
+#include <chrono>
 #include <functional>
-#include <iostream>
-#include <sstream>
+#include <memory_resource>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 #include "requirecpp/details/closure_traits.hpp"
 #include "requirecpp/details/pretty_type.hpp"
 #include "requirecpp/details/type_lookup.hpp"
@@ -11,6 +16,7 @@
 namespace requirecpp::details {
 
 using requirecpp::Context;
+using requirecpp::PendingView;
 
 class Callback {
  public:
@@ -19,82 +25,141 @@ class Callback {
   Callback& operator=(const Callback&) = delete;
   Callback& operator=(Callback&&) = default;
   ~Callback() = default;
+  // the name is allocated from resource
   template <typename Fn>
-  Callback(Fn&& callback, const std::string& name)
-      : m_called{std::make_unique<std::atomic_flag>()}, m_name{name} {
-    m_satisfied = [](const Context* ctx) -> bool {
-      return closure_traits<Fn>::template unpack_arguments_to<
-          Satisfied>::satisfied(ctx);
-    };
+  Callback(Fn&& callback,
+           std::string_view name,
+           int priority,
+           std::pmr::memory_resource* resource)
+      : m_dependencies{closure_traits<Fn>::template unpack_arguments_to<
+            Dependencies>::table()},
+        m_name{name, resource},
+        m_priority{priority} {
     m_callback = [cb = std::forward<Fn>(callback)](Context* ctx) -> void {
       closure_traits<Fn>::template unpack_arguments_to<CallHelper>::invoke(ctx,
                                                                            cb);
     };
-    m_debug = [](const Context* ctx) -> std::unordered_map<std::string, bool> {
-      return closure_traits<Fn>::template unpack_arguments_to<DebugInfo>::list(
-          ctx);
-    };
   }
 
-  bool satisfied(const Context* ctx) { return m_satisfied(ctx); }
+  // look up all dependencies once, later changes are tracked with update()
+  void refresh(const Context* ctx) {
+    m_missing = 0;
+    for (size_t i = 0; i < m_dependencies.size(); ++i) {
+      const auto& dep = m_dependencies[i];
+      if (!dep.optional && !dep.exists(ctx))
+        m_missing |= uint64_t{1} << i;
+    }
+  }
+  void update(const void* type, bool available) {
+    for (size_t i = 0; i < m_dependencies.size(); ++i) {
+      const auto& dep = m_dependencies[i];
+      if (dep.type != type || dep.optional)
+        continue;
+      if (available)
+        m_missing &= ~(uint64_t{1} << i);
+      else
+        m_missing |= uint64_t{1} << i;
+    }
+  }
+  bool satisfied() const { return m_missing == 0; }
   void call(Context* ctx) {
-    if (!m_called->test_and_set())
+    if (!std::exchange(m_called, true))
       m_callback(ctx);
   }
-  std::unordered_map<std::string, bool> list_dependecies(
-      const Context* ctx) const {
-    return m_debug(ctx);
+
+  // give up waiting at deadline and report the missing dependencies
+  template <typename OnTimeout>
+  void set_deadline(std::chrono::steady_clock::time_point deadline,
+                    OnTimeout&& on_timeout) {
+    m_deadline = deadline;
+    m_on_timeout = std::forward<OnTimeout>(on_timeout);
+  }
+  const std::optional<std::chrono::steady_clock::time_point>& get_deadline()
+      const {
+    return m_deadline;
   }
-  void print_dependencies(const Context* ctx) const {
-    for (const auto& [name, satisfied] : list_dependecies(ctx)) {
-      std::cout << "{" << name << ": " << (satisfied ? "    " : "not ")
-                << "satisfied}" << std::endl;
-    }
+  bool expired(std::chrono::steady_clock::time_point now) const {
+    return m_deadline.has_value() && *m_deadline <= now;
+  }
+  void time_out() {
+    if (!std::exchange(m_called, true) && m_on_timeout)
+      m_on_timeout(declaration());
   }
 
-  const std::string& get_name() const { return m_name; }
+  size_t dependency_count() const { return m_dependencies.size(); }
+  // appends the dependencies with their satisfaction to view
+  void copy_to(PendingView& view) const;
+  std::string declaration() const;
 
-  std::string declaration(const Context* ctx) const {
-    std::stringstream ss;
-    ss << get_name() << "(";
-    bool first = true;
-    for (const auto& [dep, satisfied] : list_dependecies(ctx)) {
-      if (first)
-        first = false;
-      else
-        ss << ", ";
-      ss << dep << (satisfied ? "" : " [missing]");
-    }
-    ss << ")";
-    return ss.str();
+  const std::pmr::string& get_name() const { return m_name; }
+  int get_priority() const { return m_priority; }
+  // bytes held by this callback, excluding the state captured by callables
+  size_t footprint() const {
+    return sizeof(Callback) + m_name.capacity();
   }
 
  private:
-  std::unique_ptr<std::atomic_flag> m_called;
-  std::function<bool(const Context*)> m_satisfied;
-  std::function<void(Context*)> m_callback;
-  std::function<std::unordered_map<std::string, bool>(const Context*)> m_debug;
-  std::string m_name;
-
-  template <typename... Tail>
-  struct Satisfied {
-    static bool satisfied(const Context* ctx) { return true; }
+  struct Dependency {
+    const void* type;
+    std::string (*type_name)();
+    bool (*exists)(const Context*);
+    bool optional;
   };
 
-  template <typename T, typename... Tail>
-  struct Satisfied<T, Tail...> {
-    static bool satisfied(const Context* ctx) {
-      return ctx->exists<T>() && Satisfied<Tail...>::satisfied(ctx);
+  // a callback is owned by one queue at a time and only called under the
+  // context lock or after it was taken out of the queues
+  bool m_called{false};
+  std::function<void(Context*)> m_callback;
+  // one static table per callback signature
+  std::span<const Dependency> m_dependencies;
+  // bit i is set while dependency i is missing
+  uint64_t m_missing{0};
+  std::pmr::string m_name;
+  int m_priority;
+  std::optional<std::chrono::steady_clock::time_point> m_deadline;
+  std::function<void(const std::string&)> m_on_timeout;
+
+  template <typename... Deps>
+  struct Dependencies {
+    static_assert(sizeof...(Deps) <= 64, "too many dependencies");
+    static std::span<const Dependency> table() {
+      static const std::array<Dependency, sizeof...(Deps)> dependencies{
+          Dependency{type_id<LookupType<Deps>>(),
+                     &type_pretty<LookupType<Deps>>,
+                     [](const Context* ctx) { return ctx->exists<Deps>(); },
+                     is_optional_dependency<Deps>()}...};
+      return dependencies;
     }
   };
 
   template <typename... Deps>
   struct CallHelper {
+    // optional dependencies are passed by value, they do not refer to the
+    // fetched shared_ptr
+    template <typename T>
+    using ArgType = std::
+        conditional_t<is_optional_dependency<T>(), std::decay_t<T>, T>;
+
     template <typename T>
-    static constexpr T convert_dep(std::shared_ptr<LookupType<T>>&& sp) {
-      if constexpr (is_specialization_of<std::shared_ptr,
+    static std::shared_ptr<LookupType<T>> fetch(Context* ctx) {
+      if constexpr (is_optional_dependency<T>()) {
+        return ctx->get<T>()->optional();
+      } else {
+        return ctx->get<T>()->now_or_throw();
+      }
+    }
+
+    template <typename T>
+    static constexpr ArgType<T> convert_dep(
+        std::shared_ptr<LookupType<T>>&& sp) {
+      if constexpr (is_specialization_of<std::weak_ptr,
                                          std::decay_t<T>>::value) {
         return sp;
+      } else if constexpr (is_optional_dependency<T>()) {
+        return sp ? std::decay_t<T>{std::move(sp)} : std::nullopt;
+      } else if constexpr (is_specialization_of<std::shared_ptr,
+                                                std::decay_t<T>>::value) {
+        return sp;
       } else if constexpr (std::is_pointer<std::decay_t<T>>()) {
         return sp.get();
       } else {
@@ -103,26 +168,7 @@ class Callback {
     }
     template <typename Callback>
     static void invoke(Context* ctx, Callback&& callback) {
-      callback(convert_dep<Deps>(ctx->get<Deps>()->now_or_throw())...);
-    }
-  };
-  template <typename... Deps>
-  struct DebugInfo {
-    static std::unordered_map<std::string, bool> list(const Context* ctx) {
-      return {};
-    }
-  };
-  template <typename Dep, typename... Deps>
-  struct DebugInfo<Dep, Deps...> {
-    static std::unordered_map<std::string, bool> list(const Context* ctx) {
-      bool satisfied = Satisfied<Dep>::satisfied(ctx);
-      auto pair = std::make_pair(
-          /* type_pretty<Dep>() + " -> " + */ type_pretty<
-              LookupType<Dep>>(),
-          satisfied);
-      auto set = DebugInfo<Deps...>::list(ctx);
-      set.emplace(pair);
-      return set;
+      callback(convert_dep<Deps>(fetch<Deps>(ctx))...);
     }
   };
 };
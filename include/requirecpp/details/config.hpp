@@ -0,0 +1,10 @@
+#pragma once
+
+// Non-template functions are inline in the header-only library. With
+// REQUIRECPP_COMPILED they are compiled once into the requirecpp_compiled
+// library instead.
+#ifdef REQUIRECPP_COMPILED
+#define REQUIRECPP_INLINE
+#else
+#define REQUIRECPP_INLINE inline
+#endif
@@ -0,0 +1,306 @@
+#pragma once
+
+// Non-template definitions of requirecpp. Included by requirecpp.ipp in the
+// header-only library, compiled into requirecpp_compiled otherwise.
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+#include "requirecpp/details/config.hpp"
+#include "requirecpp/requirecpp.hpp"
+
+namespace requirecpp::details {
+
+#ifdef __linux__
+REQUIRECPP_INLINE int eventfd_create() {
+  int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (fd < 0)
+    throw std::runtime_error{"Could not create eventfd"};
+  return fd;
+}
+
+REQUIRECPP_INLINE void eventfd_signal(int fd) {
+  const uint64_t one = 1;
+  [[maybe_unused]] auto written = ::write(fd, &one, sizeof(one));
+}
+
+REQUIRECPP_INLINE void eventfd_close(int fd) {
+  ::close(fd);
+}
+#endif
+
+REQUIRECPP_INLINE void Callback::copy_to(PendingView& view) const {
+  view.callbacks.push_back({std::string{m_name}, m_priority,
+                            static_cast<uint32_t>(view.dependencies.size()),
+                            static_cast<uint32_t>(m_dependencies.size())});
+  for (size_t i = 0; i < m_dependencies.size(); ++i) {
+    const auto& dep = m_dependencies[i];
+    view.dependencies.push_back({dep.type, dep.type_name, dep.optional,
+                                 (m_missing & (uint64_t{1} << i)) == 0});
+  }
+}
+
+REQUIRECPP_INLINE std::string Callback::declaration() const {
+  PendingView view;
+  copy_to(view);
+  return view.declaration(view.callbacks.front());
+}
+
+}  // namespace requirecpp::details
+
+namespace requirecpp {
+
+REQUIRECPP_INLINE std::string PendingView::declaration(
+    const PendingCallback& callback) const {
+  std::string ret = callback.name + "(";
+  bool first = true;
+  for (const auto& dep : dependencies_of(callback)) {
+    if (first)
+      first = false;
+    else
+      ret += ", ";
+    ret += dep.type_name();
+    if (dep.optional)
+      ret += " [optional]";
+    if (!dep.satisfied)
+      ret += " [missing]";
+  }
+  return ret + ")";
+}
+
+REQUIRECPP_INLINE void Context::details_deleter::operator()(details_callbacks* details) const {
+  std::pmr::polymorphic_allocator<details_callbacks>{resource}.delete_object(
+      details);
+}
+
+REQUIRECPP_INLINE Context::Context() : Context{std::pmr::get_default_resource()} {}
+REQUIRECPP_INLINE Context::Context(std::pmr::memory_resource* resource)
+    : m_resource{resource},
+      m_details{std::pmr::polymorphic_allocator<details_callbacks>{resource}
+                    .new_object<details_callbacks>(resource),
+                details_deleter{resource}},
+      m_destructors{resource} {}
+REQUIRECPP_INLINE Context::~Context() {
+  for (auto dtor : m_destructors) {
+    dtor();
+  }
+#ifdef __linux__
+  if (m_details->m_readiness_fd >= 0)
+    details::eventfd_close(m_details->m_readiness_fd);
+#endif
+}
+
+REQUIRECPP_INLINE std::unique_lock<std::recursive_mutex> Context::lock() const {
+  std::unique_lock lk{m_mutex, std::try_to_lock};
+  if (!lk.owns_lock()) {
+    m_details->m_lock_contentions.fetch_add(1, std::memory_order_relaxed);
+    lk.lock();
+  }
+  return lk;
+}
+
+REQUIRECPP_INLINE void Context::add_pending(details::Callback&& cb) {
+  auto lk = lock();
+  cb.refresh(this);
+  if (cb.satisfied()) {
+    // if registered by a running callback, the outer dispatch() calls it in
+    // order of priority
+    m_details->m_ready.emplace_back(std::move(cb));
+    dispatch();
+  } else if (cb.expired(std::chrono::steady_clock::now())) {
+    m_details->m_expired.emplace_back(std::move(cb));
+  } else {
+    m_details->m_pending.emplace_back(std::move(cb));
+  }
+  lk.unlock();
+  run_timeouts();
+}
+
+REQUIRECPP_INLINE void Context::expire_pending() {
+  auto lk = lock();
+  collect_expired();
+  lk.unlock();
+  run_timeouts();
+}
+
+REQUIRECPP_INLINE std::optional<std::chrono::steady_clock::time_point>
+Context::next_deadline() const {
+  std::optional<std::chrono::steady_clock::time_point> next;
+  auto lk = lock();
+  for (const auto& cb : m_details->m_pending) {
+    const auto& deadline = cb.get_deadline();
+    if (deadline && (!next || *deadline < *next))
+      next = deadline;
+  }
+  return next;
+}
+
+REQUIRECPP_INLINE void Context::collect_expired() {
+  const auto now = std::chrono::steady_clock::now();
+  std::erase_if(m_details->m_pending, [&](auto& cb) {
+    bool is_expired = cb.expired(now);
+    if (is_expired) {
+      m_details->m_expired.emplace_back(std::move(cb));
+    }
+    return is_expired;
+  });
+}
+
+REQUIRECPP_INLINE void Context::run_timeouts() {
+  std::pmr::deque<details::Callback> expired{m_resource};
+  {
+    auto lk = lock();
+    // the lock is still held by a running callback, its caller runs them
+    if (m_details->m_dispatching || m_details->m_expired.empty())
+      return;
+    expired.swap(m_details->m_expired);
+  }
+  m_details->m_timed_out.fetch_add(expired.size(), std::memory_order_relaxed);
+  for (auto& cb : expired) {
+    cb.time_out();
+  }
+}
+
+REQUIRECPP_INLINE PendingView Context::pending_view() const {
+  PendingView view;
+  auto lk = lock();
+  size_t dependencies = 0;
+  for (const auto& cb : m_details->m_pending) {
+    dependencies += cb.dependency_count();
+  }
+  view.callbacks.reserve(m_details->m_pending.size());
+  view.dependencies.reserve(dependencies);
+  for (const auto& cb : m_details->m_pending) {
+    cb.copy_to(view);
+  }
+  return view;
+}
+
+REQUIRECPP_INLINE std::vector<std::string> Context::list_pending(bool deps) const {
+  const auto view = pending_view();
+  std::vector<std::string> ret;
+  ret.reserve(view.callbacks.size());
+  for (const auto& cb : view.callbacks) {
+    if (deps) {
+      ret.emplace_back(view.declaration(cb));
+    } else {
+      ret.emplace_back(cb.name);
+    }
+  }
+  return ret;
+}
+REQUIRECPP_INLINE void Context::print_pending(bool deps) const {
+  const auto pending = list_pending(deps);
+  if (pending.empty())
+    std::cout << "No pending requirements." << std::endl;
+  for (const auto& str : pending) {
+    std::cout << str << std::endl;
+  }
+}
+
+#ifdef __linux__
+REQUIRECPP_INLINE int Context::readiness_fd() {
+  auto lk = lock();
+  if (m_details->m_readiness_fd < 0)
+    m_details->m_readiness_fd = details::eventfd_create();
+  return m_details->m_readiness_fd;
+}
+#endif
+
+REQUIRECPP_INLINE void Context::signal_readiness() {
+#ifdef __linux__
+  if (m_details->m_readiness_fd >= 0)
+    details::eventfd_signal(m_details->m_readiness_fd);
+#endif
+}
+
+REQUIRECPP_INLINE void Context::update_pending(const void* type,
+                                                bool available) {
+  for (auto& cb : m_details->m_pending) {
+    cb.update(type, available);
+  }
+  for (auto& cb : m_details->m_ready) {
+    cb.update(type, available);
+  }
+}
+
+REQUIRECPP_INLINE void Context::check_pending() {
+  std::erase_if(m_details->m_pending, [&](auto& cb) {
+    bool satisfied = cb.satisfied();
+    if (satisfied) {
+      m_details->m_ready.emplace_back(std::move(cb));
+    }
+    return satisfied;
+  });
+  collect_expired();
+  dispatch();
+}
+
+REQUIRECPP_INLINE void Context::dispatch() {
+  auto& details = *m_details;
+  // callbacks may emplace and recurse, nested calls only add to the ready
+  // queue which is drained by the outermost call
+  if (details.m_dispatching)
+    return;
+  const auto start = std::chrono::steady_clock::now();
+  details.m_dispatching = true;
+  struct DispatchGuard {
+    details_callbacks& details;
+    std::chrono::steady_clock::time_point start;
+    ~DispatchGuard() {
+      details.m_dispatching = false;
+      details.m_check_pending_ns.fetch_add(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count(),
+          std::memory_order_relaxed);
+    }
+  } guard{details, start};
+  while (!details.m_ready.empty()) {
+    // highest priority first, the first of equal priorities was ready first
+    auto next = std::ranges::max_element(details.m_ready, std::ranges::less{},
+                                         &details::Callback::get_priority);
+    auto cb = std::move(*next);
+    details.m_ready.erase(next);
+    if (!cb.satisfied()) {
+      // a callback that ran before removed a dependency
+      details.m_pending.emplace_back(std::move(cb));
+      continue;
+    }
+    details.m_resolved.fetch_add(1, std::memory_order_relaxed);
+    cb.call(this);
+  }
+}
+
+REQUIRECPP_INLINE ContextStats Context::stats() const {
+  auto lk = lock();
+  ContextStats stats{};
+  stats.objects = m_details->m_objects.load();
+  stats.pending_callbacks = m_details->m_pending.size();
+  for (const auto& cb : m_details->m_pending) {
+    stats.callback_bytes += cb.footprint();
+  }
+  stats.trackable_bytes = m_details->m_trackable_bytes.load();
+  stats.destructor_bytes =
+      m_destructors.size() * sizeof(decltype(m_destructors)::value_type);
+  stats.published = m_details->m_published.load();
+  stats.removed = m_details->m_removed.load();
+  stats.resolved_callbacks = m_details->m_resolved.load();
+  stats.timed_out_callbacks = m_details->m_timed_out.load();
+  for (const auto& [hash, probe] : m_details->m_waiter_probes) {
+    auto [name, waiting] = probe(this);
+    if (waiting > 0) {
+      stats.blocked_waiters.emplace_back(std::move(name), waiting);
+    }
+  }
+  stats.check_pending_time =
+      std::chrono::nanoseconds{m_details->m_check_pending_ns.load()};
+  stats.lock_contentions = m_details->m_lock_contentions.load();
+  return stats;
+}
+
+}  // namespace requirecpp
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace requirecpp {
+
+enum class PoolStrategy {
+  ROUND_ROBIN,
+  // instance with the fewest shared_ptr copies in use
+  LEAST_IN_FLIGHT,
+  // instance chosen by the cpu of the calling thread, round robin elsewhere
+  CPU_AFFINITY
+};
+
+}  // namespace requirecpp
+
+namespace requirecpp::details {
+
+// several instances of one type. Writers copy the instance list, readers
+// select from an immutable snapshot without locking.
+template <typename T>
+class InstancePool {
+ public:
+  using Instances = std::pmr::vector<std::shared_ptr<T>>;
+
+  // the instance lists are allocated from resource
+  explicit InstancePool(
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : m_resource{resource}, m_instances{make_instances()} {}
+  InstancePool(const InstancePool&) = delete;
+  InstancePool(InstancePool&&) = delete;
+  InstancePool& operator=(const InstancePool&) = delete;
+  InstancePool& operator=(InstancePool&&) = delete;
+  ~InstancePool() = default;
+
+  void add(const std::shared_ptr<T>& obj) {
+    std::scoped_lock lk{m_write_mutex};
+    auto instances = make_instances(*m_instances.load());
+    instances->emplace_back(obj);
+    m_instances.store(std::move(instances));
+  }
+
+  bool remove(const std::shared_ptr<T>& obj) {
+    std::scoped_lock lk{m_write_mutex};
+    auto instances = make_instances(*m_instances.load());
+    if (std::erase(*instances, obj) == 0)
+      return false;
+    m_instances.store(std::move(instances));
+    return true;
+  }
+
+  void clear() {
+    std::scoped_lock lk{m_write_mutex};
+    m_instances.store(make_instances());
+  }
+
+  // non blocking, returns nullptr if the pool is empty
+  std::shared_ptr<T> get_any(PoolStrategy strategy) const {
+    const auto instances = m_instances.load();
+    if (instances->empty())
+      return nullptr;
+    switch (strategy) {
+      case PoolStrategy::LEAST_IN_FLIGHT:
+        return *std::ranges::min_element(
+            *instances, {}, [](const auto& p) { return p.use_count(); });
+      case PoolStrategy::CPU_AFFINITY:
+#ifdef __linux__
+        if (int cpu = sched_getcpu(); cpu >= 0)
+          return (*instances)[static_cast<size_t>(cpu) % instances->size()];
+#endif
+        [[fallthrough]];
+      case PoolStrategy::ROUND_ROBIN:
+      default:
+        return (*instances)[m_next.fetch_add(1, std::memory_order_relaxed) %
+                            instances->size()];
+    }
+  }
+
+  size_t size() const { return m_instances.load()->size(); }
+
+ private:
+  // uses-allocator construction passes the resource to the vector
+  template <typename... Args>
+  std::shared_ptr<Instances> make_instances(Args&&... args) const {
+    return std::allocate_shared<Instances>(
+        std::pmr::polymorphic_allocator<>{m_resource},
+        std::forward<Args>(args)...);
+  }
+
+  std::pmr::memory_resource* m_resource;
+  std::atomic<std::shared_ptr<const Instances>> m_instances;
+  mutable std::atomic<size_t> m_next{0};
+  std::mutex m_write_mutex;
+};
+
+}  // namespace requirecpp::details
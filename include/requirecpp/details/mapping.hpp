@@ -0,0 +1,27 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <cstddef>
+
+namespace requirecpp::details {
+
+// owns a memory mapping, objects inside it keep it alive through
+// shared_ptr aliasing
+class Mapping {
+ public:
+  Mapping(void* data, std::size_t size) : m_data{data}, m_size{size} {}
+  Mapping(const Mapping&) = delete;
+  Mapping(Mapping&&) = delete;
+  Mapping& operator=(const Mapping&) = delete;
+  Mapping& operator=(Mapping&&) = delete;
+  ~Mapping() { ::munmap(m_data, m_size); }
+
+  std::byte* data() const { return static_cast<std::byte*>(m_data); }
+  std::size_t size() const { return m_size; }
+
+ private:
+  void* m_data;
+  std::size_t m_size;
+};
+
+}  // namespace requirecpp::details
@@ -7,23 +7,23 @@
 #include <memory>
 #include <sstream>
 
-namespace {
+#include <string_view>
+
+namespace requirecpp::details {
 template <auto V>
 constexpr auto valuename() {
   // Note: this might be compiler or version specific.
   constexpr std::string_view fn{__PRETTY_FUNCTION__};
-  constexpr auto value_begin = 55;
+  constexpr auto value_begin = fn.find("V = ") + 4;
   constexpr auto value_end = 1;
   return fn.substr(value_begin, fn.length() - value_begin - value_end);
 }
-}  // namespace
+}  // namespace requirecpp::details
 #endif
 
 namespace requirecpp::details {
 #ifdef __GNUG__
 
-
-namespace {
 template <auto State>
 struct PrettyValue {
   static std::string name() {
@@ -69,7 +69,7 @@ struct PrettyType<requirecpp::decorator::Tagged<T, State...>> {
     }
   }
 };
-}
+
 template <typename T>
 std::string type_pretty() {
     return PrettyType<T>::name();
@@ -2,6 +2,12 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
 #include "requirecpp/details/callback.hpp"
 #include "requirecpp/details/trackable_object.hpp"
 #include "requirecpp/requirecpp.hpp"
@@ -9,101 +15,175 @@
 namespace requirecpp {
 
 struct Context::details_callbacks {
-    std::deque<details::Callback> m_pending;
-};
+  explicit details_callbacks(std::pmr::memory_resource* resource)
+      : m_pending{resource},
+        m_ready{resource},
+        m_expired{resource},
+        m_waiter_probes{resource},
+        m_pools{std::allocate_shared<Pools>(
+            std::pmr::polymorphic_allocator<>{resource})} {}
+  std::pmr::deque<details::Callback> m_pending;
+  // satisfied callbacks waiting for dispatch by the outermost check_pending()
+  std::pmr::deque<details::Callback> m_ready;
+  // expired callbacks, their on_timeout runs after the lock is released
+  std::pmr::deque<details::Callback> m_expired;
+  // per type: pretty name and number of threads blocked in require()
+  std::pmr::unordered_map<const void*,
+                          std::pair<std::string, size_t> (*)(const Context*)>
+      m_waiter_probes;
+  bool m_dispatching{false};
+  // instance pools by details::type_index, replaced on write
+  using Pools = std::pmr::vector<std::shared_ptr<void>>;
+  std::atomic<std::shared_ptr<const Pools>> m_pools;
 
-Context::Context() :m_details{std::make_unique<details_callbacks>()} {
-}
-Context::~Context() {
-  for (auto dtor : m_destructors) {
-    dtor();
-  }
-}
+  std::atomic<size_t> m_objects{0};
+  std::atomic<size_t> m_trackable_bytes{0};
+  std::atomic<uint64_t> m_published{0};
+  std::atomic<uint64_t> m_removed{0};
+  std::atomic<uint64_t> m_resolved{0};
+  std::atomic<uint64_t> m_timed_out{0};
+  std::atomic<uint64_t> m_check_pending_ns{0};
+  // context wide eventfd, -1 until readiness_fd() is called
+  int m_readiness_fd{-1};
+  mutable std::atomic<uint64_t> m_lock_contentions{0};
+};
 
 template <typename T, typename... Args>
 std::shared_ptr<T> Context::emplace(Args&&... args) {
-  std::scoped_lock lk{m_mutex};
+  auto lk = lock();
   // todo prevent/handle overwrite
   auto p = std::make_shared<T>(std::forward<Args>(args)...);
   lookup_set_create<LookupType<T>>(p);
   check_pending();
+  lk.unlock();
+  run_timeouts();
+  return p;
+}
+
+template <typename T, typename Alloc, typename... Args>
+std::shared_ptr<T> Context::emplace_with_allocator(const Alloc& alloc,
+                                                   Args&&... args) {
+  auto lk = lock();
+  auto p = std::allocate_shared<T>(alloc, std::forward<Args>(args)...);
+  lookup_set_create<LookupType<T>>(p);
+  check_pending();
+  lk.unlock();
+  run_timeouts();
   return p;
 }
 
 template <typename T>
 void Context::push(const std::shared_ptr<T>& p) {
-  std::scoped_lock lk{m_mutex};
+  auto lk = lock();
   // todo prevent/handle overwrite
   lookup_set_create<LookupType<T>>(p);
   check_pending();
+  lk.unlock();
+  run_timeouts();
+}
+
+template <typename T, typename... Interfaces, typename... Args>
+std::shared_ptr<T> Context::provide(Args&&... args) {
+  auto p = std::make_shared<T>(std::forward<Args>(args)...);
+  push_as<Interfaces...>(p);
+  return p;
+}
+
+template <typename... Interfaces, typename T>
+void Context::push_as(const std::shared_ptr<T>& p) {
+  static_assert((std::is_convertible_v<T*, Interfaces*> && ...),
+                "object must implement all interfaces");
+  auto lk = lock();
+  lookup_set_create<LookupType<T>>(p);
+  (lookup_set_create<LookupType<Interfaces>>(
+       std::static_pointer_cast<Interfaces>(p)),
+   ...);
+  check_pending();
+  lk.unlock();
+  run_timeouts();
 }
 
 template <typename Fn>
-void Context::require(Fn&& callback, const std::string& name) {
-  details::Callback cb{callback, name};
-  std::scoped_lock lk{m_mutex};
-  if (cb.satisfied(this)) {
-    cb.call(this);
-  } else {
-    // std::cout << "add pending: " << cb.declaration(this) << std::endl;
-    m_details->m_pending.emplace_back(std::move(cb));
-  }
+void Context::require(Fn&& callback, std::string_view name, int priority) {
+  add_pending(details::Callback{callback, name, priority, m_resource});
 }
 
-std::vector<std::string> Context::list_pending(bool deps) const {
-  std::vector<std::string> ret;
-  std::scoped_lock lk{m_mutex};
-  for (const auto& cb : m_details->m_pending) {
-    if (deps) {
-      ret.emplace_back(cb.declaration(this));
-    } else {
-      ret.emplace_back(cb.get_name());
-    }
-  }
-  return ret;
-}
-void Context::print_pending(bool deps) const {
-  std::scoped_lock lk{m_mutex};
-  if (m_details->m_pending.empty())
-    std::cout << "No pending requirements." << std::endl;
-  else {
-    auto v = list_pending(deps);
-    for (const auto& str : v) {
-      std::cout << str << std::endl;
-    }
+template <typename Fn, typename OnTimeout, typename Rep, typename Period>
+void Context::require_for(Fn&& callback,
+                          const std::chrono::duration<Rep, Period>& timeout,
+                          OnTimeout&& on_timeout,
+                          std::string_view name,
+                          int priority) {
+  require_until(std::forward<Fn>(callback),
+                std::chrono::steady_clock::now() + timeout,
+                std::forward<OnTimeout>(on_timeout), name, priority);
+}
+
+template <typename Fn, typename OnTimeout, typename Clock, typename Duration>
+void Context::require_until(
+    Fn&& callback,
+    const std::chrono::time_point<Clock, Duration>& deadline,
+    OnTimeout&& on_timeout,
+    std::string_view name,
+    int priority) {
+  details::Callback cb{callback, name, priority, m_resource};
+  if constexpr (std::is_same_v<Clock, std::chrono::steady_clock>) {
+    cb.set_deadline(deadline, std::forward<OnTimeout>(on_timeout));
+  } else {
+    cb.set_deadline(std::chrono::steady_clock::now() + (deadline - Clock::now()),
+                    std::forward<OnTimeout>(on_timeout));
   }
+  add_pending(std::move(cb));
 }
 
 template <typename T>
 std::shared_ptr<details::TrackableObject<LookupType<T>>> Context::get() {
-  std::unique_lock lk{m_mutex};
+  auto lk = lock();
   return lookup_set_create<LookupType<T>>();
 }
 
+template <typename... Ts>
+std::tuple<std::shared_ptr<LookupType<Ts>>...> Context::get_all() const {
+  auto lk = lock();
+  return {lookup<Ts>()...};
+}
+
+template <typename... Ts>
+std::tuple<std::shared_ptr<LookupType<Ts>>...> Context::require_all() {
+  using Snapshot = std::tuple<std::shared_ptr<LookupType<Ts>>...>;
+  {
+    auto lk = lock();
+    if (m_details->m_dispatching) {
+      // called from a callback, this thread holds the context lock and no
+      // other thread could publish the missing objects
+      Snapshot snapshot{lookup<Ts>()...};
+      if (!std::apply([](const auto&... p) { return (p && ...); }, snapshot))
+        throw std::runtime_error{
+            "require_all called from a callback with missing objects"};
+      return snapshot;
+    }
+  }
+  // the promise is broken if the context is destroyed before all objects
+  // arrived
+  auto promise = std::make_shared<std::promise<Snapshot>>();
+  auto future = promise->get_future();
+  require(
+      [promise = std::move(promise)](
+          std::shared_ptr<LookupType<Ts>>... objects) {
+        promise->set_value(Snapshot{std::move(objects)...});
+      },
+      "require_all");
+  return future.get();
+}
+
 template <typename T>
 std::shared_ptr<LookupType<T>> Context::remove() {
-  std::unique_lock lk{m_mutex};
+  auto lk = lock();
   auto object = lookup_remove<T>();
   lk.unlock();
   return object;
 }
 
-void Context::check_pending() {
-  std::deque<details::Callback> cbs;
-  std::erase_if(m_details->m_pending, [&](auto& cb) {
-    bool satisfied = cb.satisfied(this);
-    if (satisfied) {
-      cbs.emplace_back(std::move(cb));
-    }
-    return satisfied;
-  });
-  for (auto& cb : cbs) {
-    // todo cbs can remove objects and may cannot execute. move back to
-    // m_pending? recurse?
-    cb.call(this);
-  }
-}
-
 template <typename T>
 bool Context::exists() const {
   std::shared_lock objects_lk{Context::s_objects_mutex<LookupType<T>>};
@@ -113,6 +193,50 @@ bool Context::exists() const {
          iter->second->has_value();
 }
 
+template <typename T>
+void Context::add_instance(const std::shared_ptr<T>& p) {
+  using Lookup = LookupType<T>;
+  auto lk = lock();
+  auto pool = lookup_pool<Lookup>();
+  if (pool == nullptr) {
+    pool = std::allocate_shared<details::InstancePool<Lookup>>(
+        std::pmr::polymorphic_allocator<>{m_resource}, m_resource);
+    // readers keep using the old table until the new one is stored
+    auto pools = std::allocate_shared<details_callbacks::Pools>(
+        std::pmr::polymorphic_allocator<>{m_resource},
+        *m_details->m_pools.load());
+    const auto index = details::type_index<Lookup>();
+    if (pools->size() <= index)
+      pools->resize(index + 1);
+    (*pools)[index] = pool;
+    m_details->m_pools.store(std::move(pools));
+  }
+  pool->add(p);
+}
+
+template <typename T>
+bool Context::remove_instance(const std::shared_ptr<T>& p) {
+  auto pool = lookup_pool<LookupType<T>>();
+  return pool != nullptr && pool->remove(p);
+}
+
+template <typename T>
+std::shared_ptr<LookupType<T>> Context::get_any(PoolStrategy strategy) const {
+  auto pool = lookup_pool<LookupType<T>>();
+  return pool != nullptr ? pool->get_any(strategy) : nullptr;
+}
+
+// lock free, the pool table of the context is only replaced by add_instance
+template <typename T>
+std::shared_ptr<details::InstancePool<T>> Context::lookup_pool() const {
+  const auto pools = m_details->m_pools.load();
+  const auto index = details::type_index<T>();
+  return index < pools->size()
+             ? std::static_pointer_cast<details::InstancePool<T>>(
+                   (*pools)[index])
+             : nullptr;
+}
+
 template <typename T>
 std::shared_ptr<LookupType<T>> Context::lookup_remove() {
   static_assert(std::is_same<LookupType<T>, T>::value,
@@ -122,14 +246,33 @@ std::shared_ptr<LookupType<T>> Context::lookup_remove() {
   auto iter = objects.find(this);
   if (iter != end(objects)) {
     auto trackable = iter->second;
-    auto p = trackable->optional();
-    trackable->fail();
+    auto p = trackable->release();
     objects.erase(iter);
+    m_details->m_trackable_bytes.fetch_sub(sizeof(details::TrackableObject<T>),
+                                          std::memory_order_relaxed);
+    if (p) {
+      m_details->m_objects.fetch_sub(1, std::memory_order_relaxed);
+      m_details->m_removed.fetch_add(1, std::memory_order_relaxed);
+      update_pending(details::type_id<T>(), false);
+    }
+    // the trackable object failed, reactors must fetch a new one
+    signal_readiness();
     return p;
   }
   return nullptr;
 }
 
+// retrieve without creating an empty trackable object
+template <typename T>
+std::shared_ptr<LookupType<T>> Context::lookup() const {
+  std::shared_lock objects_lk{Context::s_objects_mutex<LookupType<T>>};
+  const auto& objects = Context::s_objects<LookupType<T>>;
+  const auto& iter = objects.find(this);
+  if (iter == end(objects) || iter->second == nullptr)
+    return nullptr;
+  return iter->second->optional();
+}
+
 // retrieve, set or create empty trackable object
 template <typename T>
 std::shared_ptr<details::TrackableObject<LookupType<T>>>
@@ -139,14 +282,36 @@ Context::lookup_set_create(std::shared_ptr<T> obj_ptr) {
   std::scoped_lock objects_lk{Context::s_objects_mutex<T>};
   auto& objects = Context::s_objects<LookupType<T>>;
   auto iter = objects.find(this);
+  if (obj_ptr != nullptr) {
+    m_details->m_published.fetch_add(1, std::memory_order_relaxed);
+    if (iter == end(objects) || !iter->second->has_value())
+      m_details->m_objects.fetch_add(1, std::memory_order_relaxed);
+  }
   if (iter == end(objects)) {
     bool success;
     std::tie(iter, success) = objects.try_emplace(
-        this, std::make_shared<details::TrackableObject<T>>(obj_ptr));
+        this, std::allocate_shared<details::TrackableObject<T>>(
+                  std::pmr::polymorphic_allocator<>{m_resource}, obj_ptr));
     m_destructors.emplace_back([this] { remove<T>(); });
+    m_details->m_trackable_bytes.fetch_add(sizeof(details::TrackableObject<T>),
+                                          std::memory_order_relaxed);
+    m_details->m_waiter_probes.try_emplace(
+        details::type_id<T>(), [](const Context* ctx) {
+          std::shared_lock objects_lk{Context::s_objects_mutex<T>};
+          const auto& objects = Context::s_objects<T>;
+          const auto& iter = objects.find(ctx);
+          return std::make_pair(details::type_pretty<T>(),
+                                iter != end(objects) && iter->second != nullptr
+                                    ? iter->second->waiting()
+                                    : size_t{0});
+        });
   } else if (obj_ptr != nullptr) {
     iter->second->set(obj_ptr);
   }
+  if (obj_ptr != nullptr) {
+    update_pending(details::type_id<T>(), true);
+    signal_readiness();
+  }
   return iter->second;
 }
 
@@ -157,3 +322,7 @@ std::unordered_map<const Context*, std::shared_ptr<details::TrackableObject<T>>>
 template <typename T>
 std::shared_mutex Context::s_objects_mutex;
 }  // namespace requirecpp
+
+#ifndef REQUIRECPP_COMPILED
+#include "requirecpp/details/context.ipp"
+#endif
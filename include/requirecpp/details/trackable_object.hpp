@@ -1,11 +1,28 @@
 #pragma once
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
+#include <stop_token>
 #include <type_traits>
+#include <vector>
+#include "requirecpp/details/config.hpp"
+
+namespace requirecpp {
+class Context;
+}
 
 namespace requirecpp::details {
 
+#ifdef __linux__
+// eventfd wrappers, defined in context.ipp to keep the system headers out of
+// every translation unit
+REQUIRECPP_INLINE int eventfd_create();
+REQUIRECPP_INLINE void eventfd_signal(int fd);
+REQUIRECPP_INLINE void eventfd_close(int fd);
+#endif
+
 // if there are pending get() calls, make sure the object is not destroyed,
 // destruction: if there are pending blocking_get() calls, they hold a
 // shared_ptr.
@@ -18,22 +35,61 @@ class TrackableObject {
   TrackableObject(TrackableObject&&) = delete;
   TrackableObject& operator=(const TrackableObject&) = delete;
   TrackableObject& operator=(TrackableObject&&) = delete;
-  ~TrackableObject() = default;
+  ~TrackableObject() {
+#ifdef __linux__
+    if (m_readiness_fd >= 0)
+      eventfd_close(m_readiness_fd);
+#endif
+  }
 
   void set(const std::shared_ptr<T>& obj) {
-    std::unique_lock lk{m_mutex};
-    m_object = obj;
-    lk.unlock();
-    m_cv.notify_all();
+    std::vector<Waiter*> waiters;
+    {
+      std::scoped_lock lk{m_mutex};
+      m_object = obj;
+      if (m_object) {
+        signal_readiness();
+        waiters.swap(m_waiters);
+      }
+    }
+    hand_off(waiters, obj, false);
   }
 
   // blocking
   std::shared_ptr<T> require() {
-    std::unique_lock lk{m_mutex};
-    m_cv.wait(lk, [&] { return m_shutdown || m_object != nullptr; });
-    if (m_shutdown)
-      throw std::runtime_error{"Could not get object"};
-    return m_object;
+    return wait(
+        [](auto& lk, Waiter& waiter) {
+          waiter.cv.wait(lk, [&] { return waiter.done; });
+          return true;
+        },
+        nullptr);
+  }
+
+  // blocking, throws if the object did not arrive in time
+  template <typename Rep, typename Period>
+  std::shared_ptr<T> require_for(
+      const std::chrono::duration<Rep, Period>& timeout) {
+    return require_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  template <typename Clock, typename Duration>
+  std::shared_ptr<T> require_until(
+      const std::chrono::time_point<Clock, Duration>& deadline) {
+    return wait(
+        [&](auto& lk, Waiter& waiter) {
+          return waiter.cv.wait_until(lk, deadline,
+                                      [&] { return waiter.done; });
+        },
+        "Timeout waiting for object");
+  }
+
+  // blocking, throws if stop is requested before the object arrived
+  std::shared_ptr<T> require(std::stop_token stop) {
+    return wait(
+        [&](auto& lk, Waiter& waiter) {
+          return waiter.cv.wait(lk, stop, [&] { return waiter.done; });
+        },
+        "Waiting for object was cancelled");
   }
 
   // non blocking, may return nullptr
@@ -49,20 +105,135 @@ class TrackableObject {
     return m_object;
   }
 
+  // stops blocked and future require() calls, the object stays published
   void fail() {
+    std::vector<Waiter*> waiters;
     {
       std::scoped_lock lk{m_mutex};
       m_shutdown = true;
+      signal_readiness();
+      waiters.swap(m_waiters);
     }
-    m_cv.notify_all();
+    hand_off(waiters, nullptr, true);
   }
 
-  bool has_value() const { return m_object != nullptr; }
+  bool has_value() const {
+    std::scoped_lock lk{m_mutex};
+    return m_object != nullptr;
+  }
+
+  // number of threads blocked in require()
+  size_t waiting() {
+    std::scoped_lock lk{m_mutex};
+    return m_waiters.size();
+  }
+
+#ifdef __linux__
+  // eventfd that becomes readable when the object is set or fail() is called,
+  // for use with epoll/io_uring instead of a blocking require(). Read it to
+  // reset, then check optional(). The fd is owned and closed by this
+  // TrackableObject, keep the shared_ptr from get<T>() while the fd is
+  // registered. Context::remove() fails this object for good: if optional()
+  // is empty after a signal, fetch a new fd from get<T>(). Context::
+  // readiness_fd() does not have these restrictions.
+  int readiness_fd() {
+    std::scoped_lock lk{m_mutex};
+    if (m_readiness_fd < 0) {
+      m_readiness_fd = eventfd_create();
+      if (m_shutdown || m_object != nullptr)
+        signal_readiness();
+    }
+    return m_readiness_fd;
+  }
+#endif
 
  private:
+  friend class requirecpp::Context;
+
+  // fails this object and hands out the released object, only
+  // Context::remove() may drop it as it keeps the pending bookkeeping in sync
+  std::shared_ptr<T> release() {
+    std::vector<Waiter*> waiters;
+    std::shared_ptr<T> released;
+    {
+      std::scoped_lock lk{m_mutex};
+      released.swap(m_object);
+      m_shutdown = true;
+      signal_readiness();
+      waiters.swap(m_waiters);
+    }
+    hand_off(waiters, nullptr, true);
+    return released;
+  }
+
+  // a thread blocked in require(). Publishers hand the object over to each
+  // waiter directly and wake it on its own condition variable, so waking
+  // threads do not contend on m_mutex.
+  struct Waiter {
+    std::mutex mutex;
+    std::condition_variable_any cv;
+    std::shared_ptr<T> object;
+    bool failed{false};
+    bool done{false};
+  };
+
+  // wait_done(lock, waiter) blocks on the waiter and returns false when it
+  // gives up, which throws give_up_message
+  template <typename WaitDone>
+  std::shared_ptr<T> wait(WaitDone&& wait_done, const char* give_up_message) {
+    Waiter waiter;
+    {
+      std::scoped_lock lk{m_mutex};
+      if (m_shutdown)
+        throw std::runtime_error{"Could not get object"};
+      if (m_object)
+        return m_object;
+      m_waiters.emplace_back(&waiter);
+    }
+    std::unique_lock waiter_lk{waiter.mutex};
+    if (!wait_done(waiter_lk, waiter)) {
+      waiter_lk.unlock();
+      {
+        std::scoped_lock lk{m_mutex};
+        if (std::erase(m_waiters, &waiter) > 0)
+          throw std::runtime_error{give_up_message};
+      }
+      // a publisher already took this waiter and is about to hand off
+      waiter_lk.lock();
+      waiter.cv.wait(waiter_lk, [&] { return waiter.done; });
+    }
+    if (waiter.failed)
+      throw std::runtime_error{"Could not get object"};
+    return std::move(waiter.object);
+  }
+
+  static void hand_off(const std::vector<Waiter*>& waiters,
+                       const std::shared_ptr<T>& obj,
+                       bool failed) {
+    for (auto* waiter : waiters) {
+      // notify while locked, the waiter may return and destroy itself as soon
+      // as it sees done
+      std::scoped_lock lk{waiter->mutex};
+      waiter->object = obj;
+      waiter->failed = failed;
+      waiter->done = true;
+      waiter->cv.notify_one();
+    }
+  }
+
   std::shared_ptr<T> m_object;
   bool m_shutdown{false};
-  std::mutex m_mutex;
-  std::condition_variable m_cv;
+  mutable std::mutex m_mutex;
+  std::vector<Waiter*> m_waiters;
+#ifdef __linux__
+  int m_readiness_fd{-1};
+#endif
+
+  void signal_readiness() {
+#ifdef __linux__
+    if (m_readiness_fd >= 0)
+      eventfd_signal(m_readiness_fd);
+#endif
+  }
 };
 }  // namespace requirecpp::details
@@ -1,8 +1,14 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string_view>
 #include <type_traits>
+#include <typeinfo>
 
-namespace {
+namespace requirecpp::details {
 
 // check if a type is std::shared_ptr<T>
 template <template <typename...> class Template, typename T>
@@ -17,16 +23,36 @@ template <typename T>
 struct DeclvalHelper {
   using type = T;
 };
-}  // namespace
 
-namespace requirecpp::details {
+// weak_ptr<T> and optional<shared_ptr<T>> do not block a callback
+template <typename T>
+constexpr bool is_optional_dependency() {
+  if constexpr (is_specialization_of<std::weak_ptr, std::decay_t<T>>::value) {
+    return true;
+  } else if constexpr (is_specialization_of<std::optional,
+                                            std::decay_t<T>>::value) {
+    return is_specialization_of<
+        std::shared_ptr, typename std::decay_t<T>::value_type>::value;
+  } else {
+    return false;
+  }
+}
 
 // shared_ptr<T> -> T
+// weak_ptr<T> -> T
+// optional<shared_ptr<T>> -> T
 // T* -> T
 // const/ref T -> T
 template <typename T>
-static constexpr auto lookup_type() {
-  if constexpr (is_specialization_of<std::shared_ptr, std::decay_t<T>>::value) {
+constexpr auto lookup_type() {
+  if constexpr (is_specialization_of<std::weak_ptr, std::decay_t<T>>::value) {
+    return DeclvalHelper<
+        std::decay_t<typename std::decay_t<T>::element_type>>();
+  } else if constexpr (is_optional_dependency<T>()) {
+    return DeclvalHelper<std::decay_t<
+        typename std::decay_t<T>::value_type::element_type>>();
+  } else if constexpr (is_specialization_of<std::shared_ptr,
+                                            std::decay_t<T>>::value) {
     return DeclvalHelper<
         std::decay_t<typename std::decay_t<T>::element_type>>();
   } else if constexpr (std::is_pointer<std::decay_t<T>>()) {
@@ -41,4 +67,38 @@ template <typename T>
 using LookupType =
     typename std::invoke_result_t<decltype(lookup_type<T>)>::type;
 
+inline std::atomic<size_t> next_type_index{0};
+
+// dense index of T in this process, assigned on first use
+template <typename T>
+size_t type_index() {
+  static const size_t index =
+      next_type_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+template <typename T>
+inline constexpr char type_tag{};
+
+// identity of T in this process. Unlike type_hash, types with internal
+// linkage, e.g. in anonymous namespaces of different translation units, are
+// told apart
+template <typename T>
+constexpr const void* type_id() {
+  return &type_tag<T>;
+}
+
+// fnv-1a of the mangled name, stable across processes of one build
+template <typename T>
+uint64_t type_hash() {
+  static const uint64_t hash = [] {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (char c : std::string_view{typeid(T).name()}) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+    }
+    return hash;
+  }();
+  return hash;
+}
+
 }  // namespace requirecpp::details
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "requirecpp/requirecpp.hpp"
+
+// Instantiate the per-type machinery of frequently used components once.
+// Declare REQUIRECPP_EXTERN_COMPONENT(T) in a header seen by all translation
+// units and REQUIRECPP_INSTANTIATE_COMPONENT(T) in exactly one of them.
+
+#define REQUIRECPP_EXTERN_COMPONENT(T)                                   \
+  extern template class requirecpp::details::TrackableObject<T>;         \
+  extern template class requirecpp::details::InstancePool<T>;            \
+  extern template std::shared_ptr<requirecpp::details::TrackableObject<T>> \
+  requirecpp::Context::get<T>();                                         \
+  extern template std::shared_ptr<T> requirecpp::Context::remove<T>();   \
+  extern template bool requirecpp::Context::exists<T>() const;
+
+#define REQUIRECPP_INSTANTIATE_COMPONENT(T)                       \
+  template class requirecpp::details::TrackableObject<T>;         \
+  template class requirecpp::details::InstancePool<T>;            \
+  template std::shared_ptr<requirecpp::details::TrackableObject<T>> \
+  requirecpp::Context::get<T>();                                  \
+  template std::shared_ptr<T> requirecpp::Context::remove<T>();   \
+  template bool requirecpp::Context::exists<T>() const;
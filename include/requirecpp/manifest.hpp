@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "requirecpp/details/closure_traits.hpp"
+#include "requirecpp/details/type_lookup.hpp"
+
+// Compile time description of the components of a context. A component
+// provides its types once all of its requirements are available, so a
+// manifest can be checked for missing providers, duplicate providers and
+// cycles with static_assert:
+//
+//   using App = Manifest<
+//       Component<Provides<Db>, Requires<Config>>,
+//       Component<Provides<Config>>,
+//       Component<Provides<Server>, RequiresOf<decltype(start_server)>>>;
+//   static_assert(App::valid);
+//   constexpr auto order = App::order;  // component indices, providers first
+
+namespace requirecpp::manifest {
+
+inline constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+template <typename... Ts>
+struct Provides {};
+
+template <typename... Ts>
+struct Requires {};
+
+namespace details {
+
+using requirecpp::details::closure_traits;
+using requirecpp::details::is_optional_dependency;
+using requirecpp::details::LookupType;
+
+template <typename T, typename... Components>
+constexpr std::size_t provider_index() {
+  std::size_t index = npos;
+  std::size_t i = 0;
+  ((Components::template provides<T> && index == npos ? index = i : 0, ++i),
+   ...);
+  return index;
+}
+
+template <typename T, typename... Components>
+constexpr std::size_t provider_count() {
+  return (std::size_t{Components::template provides<T>} + ... + 0);
+}
+
+template <typename Tuple>
+struct ToRequires;
+
+template <typename... Ts>
+struct ToRequires<std::tuple<Ts...>> {
+  using type = Requires<Ts...>;
+};
+
+// callback arguments -> lookup types, optional dependencies do not block
+template <typename... Args>
+struct RequiresLookup {
+  using type = typename ToRequires<decltype(std::tuple_cat(
+      std::declval<std::conditional_t<is_optional_dependency<Args>(),
+                                      std::tuple<>,
+                                      std::tuple<LookupType<Args>>>>()...))>::
+      type;
+};
+
+}  // namespace details
+
+// requirements of a require() callback
+template <typename Fn>
+using RequiresOf = typename details::closure_traits<
+    Fn>::template unpack_arguments_to<details::RequiresLookup>::type;
+
+template <typename P, typename R = Requires<>>
+struct Component;
+
+template <typename... Ps, typename... Rs>
+struct Component<Provides<Ps...>, Requires<Rs...>> {
+  template <typename T>
+  static constexpr bool provides = (std::is_same_v<T, Ps> || ...);
+
+  template <typename... Components>
+  static constexpr bool missing_provider() {
+    return ((details::provider_index<Rs, Components...>() == npos) || ...);
+  }
+
+  template <typename... Components>
+  static constexpr bool duplicate_provider() {
+    return ((details::provider_count<Ps, Components...>() > 1) || ...);
+  }
+
+  template <std::size_t N, typename... Components>
+  static constexpr std::array<bool, N> dependencies() {
+    std::array<bool, N> deps{};
+    (
+        [&] {
+          constexpr auto index = details::provider_index<Rs, Components...>();
+          if constexpr (index != npos) {
+            deps[index] = true;
+          }
+        }(),
+        ...);
+    return deps;
+  }
+};
+
+template <typename... Components>
+struct Manifest {
+  static constexpr std::size_t size = sizeof...(Components);
+
+  template <typename T>
+  static constexpr std::size_t provider =
+      details::provider_index<T, Components...>();
+
+  static constexpr bool has_missing_providers =
+      (Components::template missing_provider<Components...>() || ...);
+  static constexpr bool has_duplicate_providers =
+      (Components::template duplicate_provider<Components...>() || ...);
+
+ private:
+  struct Resolution {
+    std::array<std::size_t, size> order{};
+    std::size_t resolved{0};
+  };
+
+  // kahn's algorithm, components in a cycle are never resolved
+  static constexpr Resolution resolve() {
+    const std::array<std::array<bool, size>, size> deps{
+        Components::template dependencies<size, Components...>()...};
+    std::array<bool, size> done{};
+    Resolution result;
+    bool progress = true;
+    while (progress) {
+      progress = false;
+      for (std::size_t i = 0; i < size; ++i) {
+        if (done[i])
+          continue;
+        bool ready = true;
+        for (std::size_t j = 0; j < size; ++j) {
+          ready = ready && (!deps[i][j] || done[j]);
+        }
+        if (ready) {
+          done[i] = true;
+          result.order[result.resolved++] = i;
+          progress = true;
+        }
+      }
+    }
+    for (std::size_t i = result.resolved; i < size; ++i) {
+      result.order[i] = npos;
+    }
+    return result;
+  }
+  static constexpr Resolution s_resolution = resolve();
+
+ public:
+  static constexpr bool has_cycles = s_resolution.resolved != size;
+  static constexpr bool valid =
+      !has_missing_providers && !has_duplicate_providers && !has_cycles;
+  // component indices in resolution order, npos for components in cycles
+  static constexpr std::array<std::size_t, size> order = s_resolution.order;
+};
+
+}  // namespace requirecpp::manifest
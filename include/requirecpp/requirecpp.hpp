@@ -1,12 +1,22 @@
 #pragma once
 
 #include <stdint.h>
+#include <chrono>
 #include <deque>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
+#include <optional>
 #include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <vector>
+#include "requirecpp/details/instance_pool.hpp"
 #include "requirecpp/details/type_lookup.hpp"
 
 namespace requirecpp::details {
@@ -18,10 +28,62 @@ class TrackableObject;
 namespace requirecpp {
 
 using details::LookupType;
+using details::type_id;
+
+struct ContextStats {
+  size_t objects;
+  size_t pending_callbacks;
+  // approximate memory held by the context, excluding the objects itself
+  size_t callback_bytes;
+  size_t trackable_bytes;
+  size_t destructor_bytes;
+  uint64_t published;
+  uint64_t removed;
+  uint64_t resolved_callbacks;
+  uint64_t timed_out_callbacks;
+  // types with threads blocked in get<T>()->require()
+  std::vector<std::pair<std::string, size_t>> blocked_waiters;
+  std::chrono::nanoseconds check_pending_time;
+  uint64_t lock_contentions;
+};
+
+// dependency of a pending callback. type is type_id<T>() of the lookup type,
+// type_name() demangles it
+struct PendingDependency {
+  const void* type;
+  std::string (*type_name)();
+  bool optional;
+  bool satisfied;
+};
+
+struct PendingCallback {
+  std::string name;
+  int priority;
+  // range of PendingView::dependencies
+  uint32_t first_dependency;
+  uint32_t dependency_count;
+};
+
+// copy of the pending callbacks without any formatting, see pending_view()
+struct PendingView {
+  std::vector<PendingCallback> callbacks;
+  std::vector<PendingDependency> dependencies;
+
+  std::span<const PendingDependency> dependencies_of(
+      const PendingCallback& callback) const {
+    return std::span{dependencies}.subspan(callback.first_dependency,
+                                           callback.dependency_count);
+  }
+  // "name(Dep, Other [missing])"
+  std::string declaration(const PendingCallback& callback) const;
+};
 
 class Context final {
  public:
   Context();
+  // bookkeeping of the context is allocated from resource, which must outlive
+  // the context and all objects retrieved from it
+  explicit Context(std::pmr::memory_resource* resource);
   Context(const Context&) = delete;
   Context(Context&&) = delete;
   Context& operator=(const Context&) = delete;
@@ -30,38 +92,129 @@ class Context final {
 
   template <typename T, typename... Args>
   std::shared_ptr<T> emplace(Args&&... args);
+  template <typename T, typename Alloc, typename... Args>
+  std::shared_ptr<T> emplace_with_allocator(const Alloc& alloc, Args&&... args);
   template <typename T>
   void push(const std::shared_ptr<T>& p);
 
+  // publish one object under its own type and each of Interfaces, pending
+  // callbacks are resolved once after all of them are registered
+  template <typename T, typename... Interfaces, typename... Args>
+  std::shared_ptr<T> provide(Args&&... args);
+  template <typename... Interfaces, typename T>
+  void push_as(const std::shared_ptr<T>& p);
+
+  // callbacks that become ready at the same time are called in order of
+  // descending priority, equal priorities keep the order of registration
   template <typename Fn>
-  void require(Fn&& callback, const std::string& name = "unnamed");
+  void require(Fn&& callback,
+               std::string_view name = "unnamed",
+               int priority = 0);
+
+  // like require, but if the callback is still pending at the deadline it is
+  // dropped and on_timeout is called with its declaration instead. Deadlines
+  // are checked on every change of the context and by expire_pending(), an
+  // idle context needs a timer at next_deadline() to call expire_pending().
+  // on_timeout is called without holding the context lock
+  template <typename Fn, typename OnTimeout, typename Rep, typename Period>
+  void require_for(Fn&& callback,
+                   const std::chrono::duration<Rep, Period>& timeout,
+                   OnTimeout&& on_timeout,
+                   std::string_view name = "unnamed",
+                   int priority = 0);
+  template <typename Fn, typename OnTimeout, typename Clock, typename Duration>
+  void require_until(
+      Fn&& callback,
+      const std::chrono::time_point<Clock, Duration>& deadline,
+      OnTimeout&& on_timeout,
+      std::string_view name = "unnamed",
+      int priority = 0);
+  // time out pending callbacks whose deadline has passed
+  void expire_pending();
+  // earliest deadline of the pending callbacks, if any
+  std::optional<std::chrono::steady_clock::time_point> next_deadline() const;
 
   template <typename T>
   std::shared_ptr<details::TrackableObject<LookupType<T>>> get();
 
+  // consistent snapshot of several objects, missing objects are nullptr
+  template <typename... Ts>
+  std::tuple<std::shared_ptr<LookupType<Ts>>...> get_all() const;
+  // blocks until all objects exist and returns them from one snapshot. Must
+  // not wait from a callback: there it throws if an object is missing
+  template <typename... Ts>
+  std::tuple<std::shared_ptr<LookupType<Ts>>...> require_all();
+
   template <typename T>
   std::shared_ptr<LookupType<T>> remove();
 
   template <typename T>
   bool exists() const;
 
+  // pools of several instances of one type, independent of the single object
+  // managed by emplace/push/get
+  template <typename T>
+  void add_instance(const std::shared_ptr<T>& p);
+  template <typename T>
+  bool remove_instance(const std::shared_ptr<T>& p);
+  // non blocking, returns nullptr if there are no instances
+  template <typename T>
+  std::shared_ptr<LookupType<T>> get_any(
+      PoolStrategy strategy = PoolStrategy::ROUND_ROBIN) const;
+
+  // satisfaction of the dependencies is maintained as objects are published
+  // and removed, the view is copied in O(pending) and formatted by the caller
+  PendingView pending_view() const;
   std::vector<std::string> list_pending(bool deps = true) const;
   void print_pending(bool deps = true) const;
 
+  std::pmr::memory_resource* get_memory_resource() const { return m_resource; }
+
+#ifdef __linux__
+  // eventfd owned by the context that becomes readable whenever an object is
+  // published or removed, valid until the context is destroyed. Read it to
+  // reset, then inspect the context, e.g. with get_all() or pending_view()
+  int readiness_fd();
+#endif
+
+  // counters are maintained atomically, taking the stats is O(pending)
+  ContextStats stats() const;
+
  private:
   struct details_callbacks;
+  struct details_deleter {
+    std::pmr::memory_resource* resource;
+    void operator()(details_callbacks* details) const;
+  };
+  std::unique_lock<std::recursive_mutex> lock() const;
+  void add_pending(details::Callback&& cb);
   void check_pending();
+  // calls the ready callbacks unless a callback is already running
+  void dispatch();
+  void collect_expired();
+  // calls on_timeout of the collected expired callbacks after unlocking
+  void run_timeouts();
+  // an object of the lookup type with hash type was published or removed
+  void update_pending(const void* type, bool available);
+  void signal_readiness();
 
   template <typename T>
   std::shared_ptr<LookupType<T>> lookup_remove();
 
+  template <typename T>
+  std::shared_ptr<LookupType<T>> lookup() const;
+
+  template <typename T>
+  std::shared_ptr<details::InstancePool<T>> lookup_pool() const;
+
   template <typename T>
   std::shared_ptr<details::TrackableObject<LookupType<T>>> lookup_set_create(
       std::shared_ptr<T> obj_ptr = nullptr);
-  std::unique_ptr<details_callbacks> m_details;
+  std::pmr::memory_resource* m_resource;
+  std::unique_ptr<details_callbacks, details_deleter> m_details;
   mutable std::recursive_mutex m_mutex;
 
-  std::deque<std::function<void()>> m_destructors;
+  std::pmr::deque<std::function<void()>> m_destructors;
 
   template <typename T>
   static std::unordered_map<const Context*,
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include "requirecpp/details/mapping.hpp"
+#include "requirecpp/requirecpp.hpp"
+
+// Components shared between processes on one host. One process publishes a
+// trivially copyable component into a named POSIX shared memory segment,
+// other processes attach to it without copying. Attaching blocks until the
+// publisher finished constructing the component. Once constructed, the
+// component is mapped read-only in every process, writes to it fault.
+
+namespace requirecpp::shm {
+
+namespace details {
+
+using requirecpp::details::Mapping;
+using requirecpp::details::type_hash;
+
+constexpr uint64_t MAGIC = 0x72657163'70736d32;  // "reqcpsm2"
+
+enum class State : uint32_t { CONSTRUCTING, READY, FAILED };
+
+struct Header {
+  std::atomic<uint64_t> magic;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  State state;
+  uint64_t type_hash;
+  uint64_t type_size;
+};
+
+// the payload starts on its own page so it can be protected separately from
+// the header, which holds the process shared mutex
+template <typename T>
+std::size_t payload_offset() {
+  const std::size_t align = std::max<std::size_t>(
+      alignof(T), static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)));
+  return (sizeof(Header) + align - 1) / align * align;
+}
+
+template <typename T>
+void protect_payload(const Mapping& mapping) {
+  if (::mprotect(mapping.data() + payload_offset<T>(), sizeof(T),
+                 PROT_READ) != 0)
+    throw std::runtime_error{"Could not protect shared memory"};
+}
+
+inline void set_state(Header* header, State state) {
+  pthread_mutex_lock(&header->mutex);
+  header->state = state;
+  pthread_cond_broadcast(&header->cond);
+  pthread_mutex_unlock(&header->mutex);
+}
+
+inline std::shared_ptr<Mapping> map(int fd, std::size_t size) {
+  void* data =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED)
+    throw std::runtime_error{"Could not map shared memory"};
+  return std::make_shared<Mapping>(data, size);
+}
+
+template <typename T>
+std::shared_ptr<const T> object_in(const std::shared_ptr<Mapping>& mapping) {
+  return {mapping,
+          std::launder(reinterpret_cast<const T*>(mapping->data() +
+                                                  payload_offset<T>()))};
+}
+
+// the context only stores mutable pointers, the pages are read-only
+template <typename T>
+void push_const(Context& ctx, const std::shared_ptr<const T>& p) {
+  ctx.push(std::const_pointer_cast<T>(p));
+}
+
+}  // namespace details
+
+// construct T in the segment name and push it to ctx. Throws if the segment
+// already exists. If constructing T throws, the segment is marked failed for
+// waiting processes and unlinked.
+template <typename T, typename... Args>
+std::shared_ptr<const T> publish(Context& ctx, const std::string& name,
+                                 Args&&... args) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "shared components must be trivially copyable");
+  const std::size_t size = details::payload_offset<T>() + sizeof(T);
+  int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+    throw std::runtime_error{"Could not create shared memory " + name};
+  // unlinks the segment unless publishing succeeded, wakes waiting processes
+  // once the header is initialized
+  struct UnlinkGuard {
+    const std::string& name;
+    std::shared_ptr<details::Mapping> mapping{};
+    details::Header* header{nullptr};
+    bool published{false};
+    ~UnlinkGuard() {
+      if (published)
+        return;
+      if (header != nullptr)
+        details::set_state(header, details::State::FAILED);
+      ::shm_unlink(name.c_str());
+    }
+  };
+  UnlinkGuard guard{name};
+  if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    ::close(fd);
+    throw std::runtime_error{"Could not resize shared memory " + name};
+  }
+  auto mapping = details::map(fd, size);
+  guard.mapping = mapping;
+  auto* header = new (mapping->data()) details::Header{};
+  pthread_mutexattr_t mutex_attr;
+  pthread_mutexattr_init(&mutex_attr);
+  pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+  pthread_mutex_init(&header->mutex, &mutex_attr);
+  pthread_mutexattr_destroy(&mutex_attr);
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+  pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&header->cond, &cond_attr);
+  pthread_condattr_destroy(&cond_attr);
+  header->state = details::State::CONSTRUCTING;
+  header->type_hash = details::type_hash<T>();
+  header->type_size = sizeof(T);
+  header->magic.store(details::MAGIC, std::memory_order_release);
+  guard.header = header;
+
+  new (mapping->data() + details::payload_offset<T>())
+      T(std::forward<Args>(args)...);
+  details::protect_payload<T>(*mapping);
+  details::set_state(header, details::State::READY);
+  guard.published = true;
+
+  auto p = details::object_in<T>(mapping);
+  details::push_const(ctx, p);
+  return p;
+}
+
+// map T published under name by another process and push it to ctx.
+// Blocks until it is published, throws on timeout or if publishing failed.
+template <typename T, typename Rep, typename Period>
+std::shared_ptr<const T> attach(Context& ctx, const std::string& name,
+                          const std::chrono::duration<Rep, Period>& timeout) {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "shared components must be trivially copyable");
+  using namespace std::chrono_literals;
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  const std::size_t size = details::payload_offset<T>() + sizeof(T);
+  auto wait_or_throw = [&](auto backoff) {
+    if (std::chrono::steady_clock::now() >= deadline)
+      throw std::runtime_error{"Timeout waiting for shared memory " + name};
+    std::this_thread::sleep_for(backoff);
+  };
+
+  // the segment does not exist or is not initialized before it is published
+  int fd;
+  struct stat st;
+  while ((fd = ::shm_open(name.c_str(), O_RDWR, 0600)) < 0 ||
+         ::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < size) {
+    if (fd >= 0)
+      ::close(fd);
+    wait_or_throw(1ms);
+  }
+  auto mapping = details::map(fd, size);
+  auto* header =
+      std::launder(reinterpret_cast<details::Header*>(mapping->data()));
+  while (header->magic.load(std::memory_order_acquire) != details::MAGIC) {
+    wait_or_throw(100us);
+  }
+  if (header->type_hash != details::type_hash<T>() ||
+      header->type_size != sizeof(T))
+    throw std::runtime_error{"Shared memory " + name + " holds another type"};
+
+  const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      deadline - std::chrono::steady_clock::now());
+  timespec abs_time;
+  clock_gettime(CLOCK_MONOTONIC, &abs_time);
+  const int64_t abs_ns =
+      abs_time.tv_nsec + std::max<int64_t>(remaining.count(), 0);
+  abs_time.tv_sec += abs_ns / 1'000'000'000;
+  abs_time.tv_nsec = abs_ns % 1'000'000'000;
+  pthread_mutex_lock(&header->mutex);
+  int error = 0;
+  while (header->state == details::State::CONSTRUCTING && error == 0) {
+    error = pthread_cond_timedwait(&header->cond, &header->mutex, &abs_time);
+  }
+  const auto state = header->state;
+  pthread_mutex_unlock(&header->mutex);
+  if (state == details::State::FAILED)
+    throw std::runtime_error{"Publishing shared memory " + name + " failed"};
+  if (state != details::State::READY)
+    throw std::runtime_error{"Timeout waiting for shared memory " + name};
+
+  details::protect_payload<T>(*mapping);
+  auto p = details::object_in<T>(mapping);
+  details::push_const(ctx, p);
+  return p;
+}
+
+// remove the segment name, processes that attached keep their mapping
+inline void unlink(const std::string& name) {
+  ::shm_unlink(name.c_str());
+}
+
+}  // namespace requirecpp::shm
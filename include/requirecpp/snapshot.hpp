@@ -0,0 +1,172 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "requirecpp/details/mapping.hpp"
+#include "requirecpp/details/type_lookup.hpp"
+#include "requirecpp/requirecpp.hpp"
+
+// Save prebuilt components to a file and publish them from a memory mapping
+// of that file on the next start, skipping their constructors.
+
+namespace requirecpp {
+
+// serialization hook, specialize it for types that are not trivially
+// copyable. load() may return an object aliasing mapping to avoid a copy.
+template <typename T>
+struct SnapshotTraits {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "specialize SnapshotTraits for this type");
+
+  static void save(std::ostream& out, const T& obj) {
+    out.write(reinterpret_cast<const char*>(&obj), sizeof(T));
+  }
+  static std::shared_ptr<T> load(std::span<std::byte> data,
+                                 const std::shared_ptr<void>& mapping) {
+    if (data.size() != sizeof(T))
+      throw std::runtime_error{"Snapshot entry has wrong size"};
+    if (reinterpret_cast<std::uintptr_t>(data.data()) % alignof(T) != 0)
+      throw std::runtime_error{"Snapshot entry is misaligned"};
+    return {mapping, reinterpret_cast<T*>(data.data())};
+  }
+};
+
+namespace details {
+
+constexpr uint64_t SNAPSHOT_MAGIC = 0x72657163'70736e31;  // "reqcpsn1"
+constexpr uint64_t SNAPSHOT_ALIGNMENT = 64;
+
+struct SnapshotEntry {
+  uint64_t type_hash;
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct SnapshotHeader {
+  uint64_t magic;
+  uint64_t count;
+};
+
+template <typename T>
+void save_entry(std::ofstream& out,
+                const std::shared_ptr<T>& obj,
+                std::vector<SnapshotEntry>& entries) {
+  if (!obj)
+    return;
+  auto offset = static_cast<uint64_t>(out.tellp());
+  offset = (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT *
+           SNAPSHOT_ALIGNMENT;
+  out.seekp(static_cast<std::streamoff>(offset));
+  SnapshotTraits<T>::save(out, *obj);
+  entries.emplace_back(SnapshotEntry{
+      type_hash<T>(), offset, static_cast<uint64_t>(out.tellp()) - offset});
+}
+
+template <typename T>
+bool load_entry(Context& ctx,
+                const std::shared_ptr<Mapping>& mapping,
+                std::span<const SnapshotEntry> entries) {
+  for (const auto& entry : entries) {
+    if (entry.type_hash != type_hash<T>())
+      continue;
+    if (entry.offset > mapping->size() ||
+        entry.size > mapping->size() - entry.offset)
+      throw std::runtime_error{"Snapshot entry exceeds file"};
+    ctx.push(SnapshotTraits<T>::load(
+        {mapping->data() + entry.offset, entry.size}, mapping));
+    return true;
+  }
+  return false;
+}
+
+}  // namespace details
+
+// write the available objects of Ts to path. Objects are taken from one
+// consistent snapshot of ctx, missing objects are skipped.
+template <typename... Ts>
+void save_snapshot(const Context& ctx, const std::string& path) {
+  const auto objects = ctx.get_all<Ts...>();
+  const std::string tmp_path = path + ".tmp";
+  try {
+    std::ofstream out{tmp_path, std::ios::binary | std::ios::trunc};
+    if (!out)
+      throw std::runtime_error{"Could not write snapshot " + path};
+    constexpr auto table_size = sizeof(details::SnapshotHeader) +
+                                sizeof...(Ts) * sizeof(details::SnapshotEntry);
+    out.seekp(table_size);
+    std::vector<details::SnapshotEntry> entries;
+    std::apply(
+        [&](const auto&... obj) {
+          (details::save_entry(out, obj, entries), ...);
+        },
+        objects);
+    const details::SnapshotHeader header{details::SNAPSHOT_MAGIC,
+                                         entries.size()};
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() *
+                                           sizeof(details::SnapshotEntry)));
+    out.close();
+    if (!out)
+      throw std::runtime_error{"Could not write snapshot " + path};
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+      throw std::runtime_error{"Could not write snapshot " + path};
+  } catch (...) {
+    std::remove(tmp_path.c_str());
+    throw;
+  }
+}
+
+// map path and push the objects of Ts found in it to ctx. The mapping is
+// private, objects can be modified without changing the file. Returns true
+// if all Ts were found.
+template <typename... Ts>
+bool load_snapshot(Context& ctx, const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    throw std::runtime_error{"Could not open snapshot " + path};
+  struct stat st;
+  if (::fstat(fd, &st) != 0 ||
+      static_cast<std::size_t>(st.st_size) < sizeof(details::SnapshotHeader)) {
+    ::close(fd);
+    throw std::runtime_error{"Invalid snapshot " + path};
+  }
+  const auto size = static_cast<std::size_t>(st.st_size);
+  void* data =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED)
+    throw std::runtime_error{"Could not map snapshot " + path};
+  auto mapping = std::make_shared<details::Mapping>(data, size);
+
+  details::SnapshotHeader header;
+  std::memcpy(&header, mapping->data(), sizeof(header));
+  if (header.magic != details::SNAPSHOT_MAGIC ||
+      header.count >
+          (size - sizeof(header)) / sizeof(details::SnapshotEntry))
+    throw std::runtime_error{"Invalid snapshot " + path};
+  const std::span<const details::SnapshotEntry> entries{
+      reinterpret_cast<const details::SnapshotEntry*>(mapping->data() +
+                                                      sizeof(header)),
+      header.count};
+  bool all = true;
+  ((all = details::load_entry<LookupType<Ts>>(ctx, mapping, entries) && all),
+   ...);
+  return all;
+}
+
+}  // namespace requirecpp
@@ -0,0 +1,4 @@
+// Compiled part of requirecpp, built with REQUIRECPP_COMPILED.
+#include "requirecpp/requirecpp.hpp"
+
+#include "requirecpp/details/context.ipp"
@@ -0,0 +1,22 @@
+module;
+
+#include "requirecpp/decorators.hpp"
+#include "requirecpp/requirecpp.hpp"
+
+export module requirecpp;
+
+export namespace requirecpp {
+using requirecpp::Context;
+using requirecpp::ContextStats;
+using requirecpp::LookupType;
+using requirecpp::PendingCallback;
+using requirecpp::PendingDependency;
+using requirecpp::PendingView;
+using requirecpp::PoolStrategy;
+using requirecpp::type_id;
+}  // namespace requirecpp
+
+export namespace requirecpp::decorator {
+using requirecpp::decorator::Restartable;
+using requirecpp::decorator::Tagged;
+}  // namespace requirecpp::decorator
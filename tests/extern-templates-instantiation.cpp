@@ -0,0 +1,7 @@
+#include "extern-templates.hpp"
+
+REQUIRECPP_INSTANTIATE_COMPONENT(Settings)
+
+void publish_settings(requirecpp::Context& context) {
+  context.emplace<Settings>(Settings{"instantiated once"});
+}
@@ -0,0 +1,19 @@
+#include <cassert>
+#include <iostream>
+#include "extern-templates.hpp"
+
+// context is used from two translation units, non-template functions of
+// requirecpp must not be defined twice
+
+int main() {
+  requirecpp::Context context;
+  std::string name;
+  context.require([&](const Settings& settings) { name = settings.name; },
+                  "read settings");
+  assert(!context.exists<Settings>());
+  publish_settings(context);
+  assert(context.exists<Settings>());
+  assert(context.get<Settings>()->optional()->name == "instantiated once");
+  std::cout << name << std::endl;
+  assert(context.remove<Settings>() != nullptr);
+}
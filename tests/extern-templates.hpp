@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+#include "requirecpp/extern_templates.hpp"
+
+struct Settings {
+  std::string name;
+};
+
+REQUIRECPP_EXTERN_COMPONENT(Settings)
+
+void publish_settings(requirecpp::Context& context);
@@ -0,0 +1,65 @@
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include "requirecpp/requirecpp.hpp"
+
+class Config {
+ public:
+  explicit Config(int version) : m_version{version} {}
+  int version() const { return m_version; }
+
+ private:
+  int m_version;
+};
+class Cache {};
+class Db {};
+
+int main() {
+  {
+    requirecpp::Context context;
+    context.emplace<Config>(1);
+    auto [config, cache] = context.get_all<Config, const Cache&>();
+    assert(config != nullptr && config->version() == 1);
+    assert(cache == nullptr);
+
+    std::jthread publisher{[&] {
+      context.emplace<Cache>();
+      context.emplace<Db>();
+    }};
+    auto [db, config2, cache2] =
+        context.require_all<Db, std::shared_ptr<Config>, Cache*>();
+    assert(db != nullptr && config2 != nullptr && cache2 != nullptr);
+
+    // callbacks hold the context lock, require_all cannot wait there
+    bool threw = false;
+    bool returned = false;
+    context.require(
+        [&](const Db&) {
+          auto [config, cache] = context.require_all<Config, Cache>();
+          returned = config != nullptr && cache != nullptr;
+          try {
+            context.require_all<Config, int>();
+          } catch (const std::runtime_error& e) {
+            std::cout << "require_all in callback: " << e.what() << std::endl;
+            threw = true;
+          }
+        },
+        "nested require_all");
+    assert(returned && threw);
+  }
+  {
+    auto context = std::make_shared<requirecpp::Context>();
+    std::jthread waiter{[&] {
+      try {
+        context->require_all<Db>();
+        assert(false);
+      } catch (const std::exception& e) {
+        std::cout << "require_all unsatisfied: " << e.what() << std::endl;
+      }
+    }};
+    while (context->list_pending().empty()) {
+      std::this_thread::yield();
+    }
+    context.reset();
+  }
+}
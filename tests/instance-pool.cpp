@@ -0,0 +1,61 @@
+#include <cassert>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+#include "requirecpp/requirecpp.hpp"
+
+using requirecpp::PoolStrategy;
+
+class Connection {
+ public:
+  explicit Connection(int id) : m_id{id} {}
+  int id() const { return m_id; }
+
+ private:
+  int m_id;
+};
+
+int main() {
+  requirecpp::Context context;
+  assert(context.get_any<Connection>() == nullptr);
+
+  std::vector<std::shared_ptr<Connection>> connections;
+  for (int i = 0; i < 4; ++i) {
+    connections.emplace_back(std::make_shared<Connection>(i));
+    context.add_instance(connections.back());
+  }
+
+  // round robin visits every instance
+  std::set<int> visited;
+  for (int i = 0; i < 4; ++i) {
+    visited.insert(context.get_any<Connection>()->id());
+  }
+  assert(visited.size() == 4);
+
+  // every held connection counts as in flight, so each pick is another
+  // instance and the fourth pick is the one left idle
+  auto busy0 = context.get_any<Connection>(PoolStrategy::LEAST_IN_FLIGHT);
+  auto busy1 = context.get_any<Connection>(PoolStrategy::LEAST_IN_FLIGHT);
+  auto busy2 = context.get_any<Connection>(PoolStrategy::LEAST_IN_FLIGHT);
+  assert(busy0 != busy1 && busy1 != busy2 && busy0 != busy2);
+  auto idle = context.get_any<Connection>(PoolStrategy::LEAST_IN_FLIGHT);
+  assert(idle != busy0 && idle != busy1 && idle != busy2);
+
+  assert(context.get_any<Connection>(PoolStrategy::CPU_AFFINITY) != nullptr);
+
+  assert(context.remove_instance(connections[0]));
+  assert(!context.remove_instance(connections[0]));
+  {
+    std::vector<std::jthread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&] {
+        for (int i = 0; i < 1000; ++i) {
+          auto c = context.get_any<Connection>();
+          assert(c != nullptr && c->id() != 0);
+        }
+      });
+    }
+  }
+  std::cout << "pool ok" << std::endl;
+}
@@ -0,0 +1,51 @@
+#include <cassert>
+#include <iostream>
+#include "requirecpp/requirecpp.hpp"
+
+class Wheels {
+ public:
+  virtual ~Wheels() = default;
+  virtual std::string get_type() const = 0;
+};
+
+class Tires {
+ public:
+  virtual ~Tires() = default;
+  virtual int get_profile() const = 0;
+};
+
+class SummerTires : public Wheels, public Tires {
+ public:
+  std::string get_type() const override { return "Summer"; }
+  int get_profile() const override { return 8; }
+};
+
+class WinterTires : public Wheels, public Tires {
+ public:
+  std::string get_type() const override { return "Winter"; }
+  int get_profile() const override { return 4; }
+};
+
+int main() {
+  requirecpp::Context context;
+  int calls = 0;
+  context.require(
+      [&](const Wheels& wheels, const Tires& tires, const SummerTires&) {
+        std::cout << wheels.get_type() << " tires with " << tires.get_profile()
+                  << "mm profile" << std::endl;
+        ++calls;
+      },
+      "mount");
+
+  auto tires = context.provide<SummerTires, Wheels, Tires>();
+  assert(calls == 1);
+  assert(context.get<Wheels>()->optional().get() ==
+         static_cast<Wheels*>(tires.get()));
+  assert(context.get<Tires>()->optional().get() ==
+         static_cast<Tires*>(tires.get()));
+
+  context.push_as<Wheels, Tires>(std::make_shared<WinterTires>());
+  assert(context.get<Wheels>()->optional()->get_type() == "Winter");
+  assert(context.get<Tires>()->optional()->get_profile() == 4);
+  assert(context.exists<WinterTires>());
+}
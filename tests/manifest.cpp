@@ -0,0 +1,52 @@
+#include <iostream>
+#include <memory>
+#include <optional>
+#include "requirecpp/manifest.hpp"
+#include "requirecpp/requirecpp.hpp"
+
+using namespace requirecpp::manifest;
+
+class Config {};
+class Db {};
+class Cache {};
+class Metrics {};
+class Server {};
+
+auto start_server = [](const Db&, std::shared_ptr<Cache>,
+                       std::weak_ptr<Metrics>) {};
+
+static_assert(std::is_same_v<RequiresOf<decltype(start_server)>,
+                             Requires<Db, Cache>>);
+
+using App = Manifest<
+    Component<Provides<Server>, RequiresOf<decltype(start_server)>>,
+    Component<Provides<Db, Cache>, Requires<Config>>,
+    Component<Provides<Config>>>;
+static_assert(App::valid);
+static_assert(App::provider<Cache> == 1);
+static_assert(App::provider<Metrics> == npos);
+static_assert(App::order[0] == 2 && App::order[1] == 1 && App::order[2] == 0);
+
+using MissingConfig = Manifest<Component<Provides<Db>, Requires<Config>>>;
+static_assert(MissingConfig::has_missing_providers);
+static_assert(!MissingConfig::valid);
+
+using TwoDbs =
+    Manifest<Component<Provides<Db>>, Component<Provides<Db, Cache>>>;
+static_assert(TwoDbs::has_duplicate_providers);
+static_assert(!TwoDbs::has_cycles);
+
+using ChickenEgg = Manifest<Component<Provides<Db>, Requires<Cache>>,
+                            Component<Provides<Cache>, Requires<Db>>,
+                            Component<Provides<Config>>>;
+static_assert(ChickenEgg::has_cycles);
+static_assert(!ChickenEgg::has_missing_providers);
+static_assert(ChickenEgg::order[0] == 2 && ChickenEgg::order[1] == npos);
+
+int main() {
+  // the resolution order is available at runtime, e.g. to start components
+  for (auto index : App::order) {
+    std::cout << index << " ";
+  }
+  std::cout << std::endl;
+}
@@ -0,0 +1,90 @@
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include "requirecpp/requirecpp.hpp"
+
+// counts allocations from the global allocator
+std::atomic<std::size_t> global_allocations{0};
+
+void* operator new(std::size_t size) {
+  ++global_allocations;
+  if (void* p = std::malloc(size == 0 ? 1 : size))
+    return p;
+  throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+class Request {
+ public:
+  explicit Request(int id) : m_id{id} {}
+  int id() const { return m_id; }
+
+ private:
+  int m_id;
+};
+class Session {};
+class Connection {};
+
+// counts allocations that reach the upstream resource
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  std::size_t allocations{0};
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+int handle_request(std::pmr::memory_resource* resource) {
+  requirecpp::Context context{resource};
+  assert(context.get_memory_resource() == resource);
+  int id = 0;
+  context.require([&](const Request& request,
+                      const Session&) { id = request.id(); },
+                  "handle the incoming request");
+  context.emplace_with_allocator<Request>(
+      std::pmr::polymorphic_allocator<>{resource}, 42);
+  context.emplace_with_allocator<Session>(
+      std::pmr::polymorphic_allocator<>{resource});
+  context.add_instance(std::allocate_shared<Connection>(
+      std::pmr::polymorphic_allocator<>{resource}));
+  return id;
+}
+
+int main() {
+  // first use creates the buckets of the static per-type maps
+  CountingResource resource;
+  assert(handle_request(&resource) == 42);
+  assert(resource.allocations > 0);
+
+  CountingResource upstream;
+  std::array<std::byte, 16384> buffer;
+  std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size(),
+                                            &upstream};
+  const auto before = global_allocations.load();
+  assert(handle_request(&arena) == 42);
+  const auto global = global_allocations.load() - before;
+  std::cout << "global allocations: " << global << std::endl;
+  // the documented exception: one node per type in the static object maps,
+  // which are shared by all contexts
+  assert(global == 2);
+  assert(upstream.allocations == 0);
+}
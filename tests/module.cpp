@@ -0,0 +1,17 @@
+#include <cassert>
+#include <memory>
+#include <string>
+import requirecpp;
+
+// consumer of the requirecpp module, built with REQUIRECPP_MODULE
+
+class Db {};
+
+int main() {
+  requirecpp::Context context;
+  bool called = false;
+  context.require([&](const Db&) { called = true; }, "use db");
+  context.emplace<Db>();
+  assert(called);
+  assert(context.stats().objects == 1);
+}
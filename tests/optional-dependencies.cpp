@@ -0,0 +1,45 @@
+#include <cassert>
+#include <iostream>
+#include <optional>
+#include "requirecpp/requirecpp.hpp"
+
+class Server {};
+class Metrics {};
+class Tracer {};
+
+int main() {
+  std::weak_ptr<Metrics> late_metrics;
+  {
+    requirecpp::Context context;
+    bool started = false;
+    context.require(
+        [&](const Server&, std::weak_ptr<Metrics> metrics,
+            const std::optional<std::shared_ptr<Tracer>>& tracer) {
+          // degraded mode, metrics and tracer did not arrive yet
+          assert(metrics.expired());
+          assert(!tracer.has_value());
+          started = true;
+        },
+        "start");
+    // companion callback picks up the late metrics sink
+    context.require([&](std::shared_ptr<Metrics> metrics) {
+      late_metrics = metrics;
+    }, "attach metrics");
+    context.emplace<Server>();
+    assert(started);
+    context.print_pending();
+
+    context.emplace<Metrics>();
+    assert(!late_metrics.expired());
+
+    bool traced = false;
+    context.emplace<Tracer>();
+    context.require(
+        [&](std::optional<std::shared_ptr<Tracer>> tracer) {
+          traced = tracer.has_value() && *tracer != nullptr;
+        },
+        "trace");
+    assert(traced);
+  }
+  assert(late_metrics.expired());
+}
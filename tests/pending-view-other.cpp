@@ -0,0 +1,11 @@
+#include "requirecpp/requirecpp.hpp"
+
+// a different type than Foo in pending-view.cpp, but with the same mangled
+// name and type_hash
+namespace {
+struct Foo {};
+}  // namespace
+
+void publish_other_foo(requirecpp::Context& context) {
+  context.emplace<Foo>();
+}
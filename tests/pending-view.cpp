@@ -0,0 +1,71 @@
+#include <cassert>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+#include "requirecpp/requirecpp.hpp"
+
+class Db {};
+class Cache {};
+class Metrics {};
+
+namespace {
+struct Foo {};
+}  // namespace
+
+void publish_other_foo(requirecpp::Context& context);
+
+int main() {
+  requirecpp::Context context;
+  context.require([](const Db&, std::shared_ptr<Cache>,
+                     std::weak_ptr<Metrics>) {},
+                  "serve", 5);
+  context.require([](const Cache&, Db*) {}, "warmup");
+
+  auto view = context.pending_view();
+  assert(view.callbacks.size() == 2);
+  assert(view.dependencies.size() == 5);
+  const auto& serve = view.callbacks[0];
+  assert(serve.name == "serve" && serve.priority == 5);
+  auto deps = view.dependencies_of(serve);
+  assert(deps.size() == 3);
+  assert(deps[0].type == requirecpp::type_id<Db>());
+  assert(deps[0].type_name() == "Db");
+  assert(!deps[0].satisfied && !deps[1].satisfied);
+  // optional dependencies never block
+  assert(deps[2].optional && deps[2].satisfied);
+  std::cout << view.declaration(serve) << std::endl;
+  assert(view.declaration(serve) ==
+         "serve(Db [missing], Cache [missing], Metrics [optional])");
+
+  // satisfaction follows published and removed objects
+  context.emplace<Cache>();
+  view = context.pending_view();
+  assert(view.dependencies_of(view.callbacks[0])[1].satisfied);
+  assert(view.dependencies_of(view.callbacks[1])[0].satisfied);
+  context.remove<Cache>();
+  view = context.pending_view();
+  assert(!view.dependencies_of(view.callbacks[0])[1].satisfied);
+
+  // the view is a copy, the context may change while it is rendered
+  auto pending = context.list_pending();
+  assert(pending.size() == 2);
+  assert(pending[1] == "warmup(Cache [missing], Db [missing])");
+  assert(context.list_pending(false)[0] == "serve");
+
+  context.emplace<Db>();
+  context.emplace<Cache>();
+  assert(context.pending_view().callbacks.empty());
+  context.print_pending();
+
+  // types with the same mangled name from different translation units do not
+  // satisfy each other
+  bool called = false;
+  context.require([&](const Foo&) { called = true; }, "foo");
+  publish_other_foo(context);
+  assert(!called);
+  assert(context.list_pending() ==
+         std::vector<std::string>{"foo((anonymous namespace)::Foo [missing])"});
+  context.emplace<Foo>();
+  assert(called);
+}
@@ -0,0 +1,66 @@
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include "requirecpp/requirecpp.hpp"
+
+class Config {};
+class Socket {};
+
+int main() {
+  requirecpp::Context context;
+  std::vector<std::string> order;
+  context.require([&](const Config&) { order.emplace_back("cache_warmer"); },
+                  "cache_warmer");
+  context.require([&](const Config&) { order.emplace_back("health_check"); },
+                  "health_check", 10);
+  context.require([&](const Config&) { order.emplace_back("metrics"); },
+                  "metrics");
+  context.require(
+      [&](const Config&) {
+        order.emplace_back("listen");
+        context.emplace<Socket>();
+      },
+      "listen", 100);
+  context.require([&](const Socket&) { order.emplace_back("accept"); },
+                  "accept", 100);
+
+  context.emplace<Config>();
+  for (const auto& name : order) {
+    std::cout << name << std::endl;
+  }
+  // "accept" becomes ready while "listen" runs and is scheduled immediately
+  assert((order == std::vector<std::string>{"listen", "accept", "health_check",
+                                            "cache_warmer", "metrics"}));
+
+  // a callback that becomes ready while another runs does not overtake the
+  // higher priorities that were ready before
+  requirecpp::Context nested;
+  order.clear();
+  nested.require(
+      [&](const Config&) {
+        order.emplace_back("listen");
+        nested.emplace<Socket>();
+      },
+      "listen", 100);
+  nested.require([&](const Config&) { order.emplace_back("health"); },
+                 "health", 10);
+  nested.require([&](const Socket&) { order.emplace_back("warm"); }, "warm",
+                 -100);
+  nested.emplace<Config>();
+  assert((order == std::vector<std::string>{"listen", "health", "warm"}));
+
+  // the same for a satisfied callback registered by a running callback
+  requirecpp::Context registering;
+  order.clear();
+  registering.require(
+      [&](const Config&) {
+        order.emplace_back("listen");
+        registering.require([&](const Config&) { order.emplace_back("warm"); },
+                            "warm", -100);
+      },
+      "listen", 100);
+  registering.require([&](const Config&) { order.emplace_back("health"); },
+                      "health", 10);
+  registering.emplace<Config>();
+  assert((order == std::vector<std::string>{"listen", "health", "warm"}));
+}
@@ -0,0 +1,65 @@
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include "requirecpp/requirecpp.hpp"
+
+using namespace std::chrono_literals;
+
+class Db {};
+class Cache {};
+
+bool readable(int fd, int timeout_ms) {
+  pollfd pfd{fd, POLLIN, 0};
+  return ::poll(&pfd, 1, timeout_ms) == 1 && (pfd.revents & POLLIN);
+}
+
+int main() {
+  requirecpp::Context context;
+  auto db = context.get<Db>();
+  int fd = db->readiness_fd();
+  assert(!readable(fd, 0));
+
+  std::jthread publisher{[&] {
+    std::this_thread::sleep_for(10ms);
+    context.emplace<Db>();
+  }};
+  assert(readable(fd, 10000));
+  eventfd_t value;
+  assert(::eventfd_read(fd, &value) == 0);
+  assert(db->optional() != nullptr);
+  assert(!readable(fd, 0));
+
+  // already available objects are signalled immediately
+  context.emplace<Cache>();
+  assert(readable(context.get<Cache>()->readiness_fd(), 0));
+
+  // removal fails the trackable object and wakes the reactor
+  context.remove<Db>();
+  assert(readable(fd, 0));
+  assert(::eventfd_read(fd, &value) == 0);
+  assert(db->optional() == nullptr);
+
+  // the failed object is not signalled again, a re-published object must be
+  // waited on with a new fd
+  auto new_db = context.get<Db>();
+  int new_fd = new_db->readiness_fd();
+  assert(new_fd != fd && !readable(new_fd, 0));
+  context.emplace<Db>();
+  assert(readable(new_fd, 0));
+  assert(!readable(fd, 0));
+
+  // the context wide fd signals every publish and removal
+  int context_fd = context.readiness_fd();
+  assert(context.readiness_fd() == context_fd);
+  assert(!readable(context_fd, 0));
+  context.remove<Db>();
+  assert(readable(context_fd, 0));
+  assert(::eventfd_read(context_fd, &value) == 0);
+  context.emplace<Db>();
+  assert(readable(context_fd, 0));
+  assert(::eventfd_read(context_fd, &value) == 0);
+  assert(context.exists<Db>());
+  std::cout << "readiness fd ok" << std::endl;
+}
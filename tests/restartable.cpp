@@ -0,0 +1,94 @@
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "requirecpp/decorators.hpp"
+#include "requirecpp/requirecpp.hpp"
+
+using requirecpp::decorator::Restartable;
+
+class Cache {
+ public:
+  explicit Cache(int generation) : m_generation{generation} { ++s_alive; }
+  ~Cache() {
+    m_generation = -1;
+    --s_alive;
+  }
+  int generation() const { return m_generation; }
+
+  static inline std::atomic<int> s_alive{0};
+
+ private:
+  int m_generation;
+};
+
+int main() {
+  {
+    requirecpp::Context context;
+    auto cache = context.emplace<Restartable<Cache>>(0);
+    int starts = 0;
+    int stops = 0;
+    cache->on_start([&] { ++starts; });
+    cache->before_stop([&] { ++stops; });
+    assert(starts == 1);
+
+    // a reader keeps the old instance alive across a restart
+    auto guard = cache->get_object();
+    cache->recreate(1);
+    assert(guard->generation() == 0);
+    assert(cache->get_object()->generation() == 1);
+    assert(Cache::s_alive == 2);
+    guard.reset();
+    assert(Cache::s_alive == 1);
+    assert(starts == 2 && stops == 1);
+
+    std::atomic<bool> running{true};
+    std::vector<std::jthread> readers;
+    for (int t = 0; t < 4; ++t) {
+      readers.emplace_back([&] {
+        while (running) {
+          auto object = context.get<Restartable<Cache>>()->optional();
+          auto current = object->get_object();
+          assert(current != nullptr && current->generation() >= 1);
+        }
+      });
+    }
+    for (int generation = 2; generation < 200; ++generation) {
+      cache->recreate(generation);
+    }
+    running = false;
+    readers.clear();
+    assert(stops == 199);
+
+    cache->reset();
+    assert(cache->get_object() == nullptr);
+    assert(stops == 200);
+  }
+  assert(Cache::s_alive == 0);
+  {
+    // hooks may use the Restartable they belong to
+    Restartable<Cache> cache{0};
+    int stops = 0;
+    cache.on_start([&] {
+      if (cache.get_object()->generation() == 1) {
+        cache.before_stop([&] { ++stops; });
+        cache.recreate(2);
+      }
+    });
+    cache.recreate(1);
+    assert(stops == 1);
+    assert(cache.get_object()->generation() == 2);
+    bool nested = false;
+    cache.before_stop([&] {
+      if (!std::exchange(nested, true))
+        cache.reset();
+    });
+    cache.reset();
+    assert(nested && stops == 3);
+    assert(cache.get_object() == nullptr);
+  }
+  assert(Cache::s_alive == 0);
+  std::cout << "restartable ok" << std::endl;
+}
@@ -0,0 +1,101 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include <array>
+#include <cassert>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include "requirecpp/requirecpp.hpp"
+#include "requirecpp/shared_memory.hpp"
+
+using namespace std::chrono_literals;
+
+struct LookupTable {
+  std::array<int, 1024> values;
+};
+
+struct Model {
+  double weights[16];
+};
+
+struct Checked {
+  explicit Checked(bool valid) : value{42} {
+    if (!valid)
+      throw std::runtime_error{"invalid"};
+  }
+  int value;
+};
+
+int main() {
+  const std::string name = "/requirecpp-test-" + std::to_string(::getpid());
+  requirecpp::shm::unlink(name);
+
+  pid_t child = ::fork();
+  if (child == 0) {
+    // worker process: waits for the publisher and maps the table zero copy
+    requirecpp::Context context;
+    int sum = 0;
+    context.require(
+        [&](const LookupTable& table) {
+          sum = std::accumulate(table.values.begin(), table.values.end(), 0);
+        },
+        "sum");
+    auto table = requirecpp::shm::attach<LookupTable>(context, name, 10s);
+    // the table is read-only, a write faults
+    pid_t writer = ::fork();
+    if (writer == 0) {
+      const_cast<volatile int&>(table->values[0]) = -1;
+      ::_exit(0);
+    }
+    int writer_status = 0;
+    ::waitpid(writer, &writer_status, 0);
+    // killed by SIGSEGV, or exited with an error when a sanitizer handles it
+    const bool read_only =
+        !WIFEXITED(writer_status) || WEXITSTATUS(writer_status) != 0;
+    bool wrong_type = false;
+    try {
+      requirecpp::Context other;
+      requirecpp::shm::attach<Model>(other, name, 1s);
+    } catch (const std::exception& e) {
+      wrong_type = true;
+    }
+    ::_exit(sum == 1024 * 1023 / 2 && read_only && wrong_type ? 0 : 1);
+  }
+
+  std::this_thread::sleep_for(10ms);
+  requirecpp::Context context;
+  LookupTable prebuilt;
+  std::iota(prebuilt.values.begin(), prebuilt.values.end(), 0);
+  auto table = requirecpp::shm::publish<LookupTable>(context, name, prebuilt);
+  assert(context.get<LookupTable>()->optional() == table);
+  int status = 0;
+  ::waitpid(child, &status, 0);
+  requirecpp::shm::unlink(name);
+
+  bool timed_out = false;
+  try {
+    requirecpp::Context other;
+    requirecpp::shm::attach<LookupTable>(other, name, 10ms);
+  } catch (const std::exception& e) {
+    std::cout << e.what() << std::endl;
+    timed_out = true;
+  }
+  assert(timed_out);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  // a failed publish removes the segment, the name can be published again
+  bool failed = false;
+  try {
+    requirecpp::Context other;
+    requirecpp::shm::publish<Checked>(other, name, false);
+  } catch (const std::runtime_error&) {
+    failed = true;
+  }
+  assert(failed);
+  {
+    requirecpp::Context other;
+    assert(requirecpp::shm::publish<Checked>(other, name, true)->value == 42);
+    requirecpp::shm::unlink(name);
+  }
+  std::cout << "shared memory ok" << std::endl;
+}
@@ -0,0 +1,147 @@
+#include <unistd.h>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include "requirecpp/requirecpp.hpp"
+#include "requirecpp/snapshot.hpp"
+
+struct Index {
+  std::array<int, 4096> buckets;
+};
+
+struct Settings {
+  int threads;
+  double ratio;
+};
+
+// not trivially copyable, serialized by a custom hook
+struct Name {
+  std::string value;
+};
+
+template <>
+struct requirecpp::SnapshotTraits<Name> {
+  static void save(std::ostream& out, const Name& name) { out << name.value; }
+  static std::shared_ptr<Name> load(std::span<std::byte> data,
+                                    const std::shared_ptr<void>&) {
+    return std::make_shared<Name>(
+        Name{{reinterpret_cast<const char*>(data.data()), data.size()}});
+  }
+};
+
+class Missing {};
+
+// fails while saving
+struct Broken {};
+
+template <>
+struct requirecpp::SnapshotTraits<Broken> {
+  static void save(std::ostream&, const Broken&) {
+    throw std::runtime_error{"cannot save"};
+  }
+  static std::shared_ptr<Broken> load(std::span<std::byte>,
+                                      const std::shared_ptr<void>&) {
+    return nullptr;
+  }
+};
+
+// writes a header with count and the given entries, padded to 256 bytes
+static void write_raw(const std::string& path,
+                      uint64_t count,
+                      std::initializer_list<requirecpp::details::SnapshotEntry>
+                          entries) {
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  const requirecpp::details::SnapshotHeader header{
+      requirecpp::details::SNAPSHOT_MAGIC, count};
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (const auto& entry : entries)
+    out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+  const std::string padding(256, '\0');
+  out.write(padding.data(), static_cast<std::streamsize>(
+                                padding.size() - out.tellp()));
+}
+
+static bool rejected(const std::string& path) {
+  requirecpp::Context context;
+  try {
+    requirecpp::load_snapshot<Settings>(context, path);
+  } catch (const std::runtime_error&) {
+    return !context.exists<Settings>();
+  }
+  return false;
+}
+
+int main() {
+  const std::string path =
+      "requirecpp-snapshot-" + std::to_string(::getpid()) + ".bin";
+  {
+    requirecpp::Context context;
+    auto index = context.emplace<Index>();
+    std::iota(index->buckets.begin(), index->buckets.end(), 0);
+    context.emplace<Settings>(Settings{8, 0.5});
+    context.emplace<Name>(Name{"warm index"});
+    requirecpp::save_snapshot<Index, Settings, Name, Missing>(context, path);
+  }
+  {
+    requirecpp::Context context;
+    bool ready = false;
+    context.require(
+        [&](const Index& index, const Settings& settings, const Name& name) {
+          assert(index.buckets[4095] == 4095);
+          assert(settings.threads == 8 && settings.ratio == 0.5);
+          assert(name.value == "warm index");
+          ready = true;
+        },
+        "serve");
+    bool complete = requirecpp::load_snapshot<Index, Settings, Name, Missing>(
+        context, path);
+    assert(ready);
+    assert(!complete);
+    assert(!context.exists<Missing>());
+    // the mapping is private, modifications do not reach the file
+    context.get<Index>()->optional()->buckets[0] = 42;
+  }
+  {
+    requirecpp::Context context;
+    assert(requirecpp::load_snapshot<Index>(context, path));
+    assert(context.get<Index>()->optional()->buckets[0] == 0);
+  }
+  {
+    // a failed save keeps the previous snapshot and leaves no temporary file
+    requirecpp::Context context;
+    context.emplace<Broken>();
+    bool thrown = false;
+    try {
+      requirecpp::save_snapshot<Broken>(context, path);
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    assert(thrown);
+    assert(::access((path + ".tmp").c_str(), F_OK) != 0);
+    requirecpp::Context loaded;
+    assert(requirecpp::load_snapshot<Index>(loaded, path));
+  }
+  {
+    // corrupted tables must not overflow the bounds checks
+    const auto hash = requirecpp::details::type_hash<Settings>();
+    write_raw(path, 0x0AAAAAAAAAAAAAAB, {});
+    assert(rejected(path));
+    write_raw(path, 1, {{hash, UINT64_MAX - 4, sizeof(Settings)}});
+    assert(rejected(path));
+    write_raw(path, 1, {{hash, 64, UINT64_MAX}});
+    assert(rejected(path));
+    // misaligned for Settings
+    write_raw(path, 1, {{hash, 65, sizeof(Settings)}});
+    assert(rejected(path));
+    write_raw(path, 1, {{hash, 64, sizeof(Settings)}});
+    requirecpp::Context context;
+    assert(requirecpp::load_snapshot<Settings>(context, path));
+  }
+  std::remove(path.c_str());
+  std::cout << "snapshot ok" << std::endl;
+}
@@ -0,0 +1,54 @@
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include "requirecpp/requirecpp.hpp"
+
+using namespace std::chrono_literals;
+
+class Db {};
+class Cache {};
+class Metrics {};
+
+int main() {
+  requirecpp::Context context;
+  context.require([](const Db&, const Cache&) {}, "serve");
+  context.require([](const Metrics&) {}, "export");
+  context.require_for([](const Metrics&, const Db&) {}, 0s,
+                      [](const std::string&) {}, "expired");
+
+  auto stats = context.stats();
+  assert(stats.objects == 0);
+  assert(stats.pending_callbacks == 2);
+  assert(stats.callback_bytes > 0);
+  assert(stats.timed_out_callbacks == 1);
+
+  std::jthread waiter{[&] { context.get<Cache>()->require(); }};
+  while (context.stats().blocked_waiters.empty()) {
+    std::this_thread::yield();
+  }
+  stats = context.stats();
+  assert(stats.blocked_waiters.size() == 1);
+  assert(stats.blocked_waiters[0].first == "Cache");
+  assert(stats.blocked_waiters[0].second == 1);
+
+  context.emplace<Db>();
+  context.emplace<Cache>();
+  waiter.join();
+  context.push(std::make_shared<Cache>());
+  context.remove<Db>();
+
+  stats = context.stats();
+  assert(stats.objects == 1);
+  assert(stats.pending_callbacks == 1);
+  assert(stats.published == 3);
+  assert(stats.removed == 1);
+  assert(stats.resolved_callbacks == 1);
+  assert(stats.blocked_waiters.empty());
+  assert(stats.trackable_bytes > 0);
+  assert(stats.destructor_bytes > 0);
+  assert(stats.check_pending_time.count() > 0);
+  std::cout << "objects: " << stats.objects
+            << ", pending: " << stats.pending_callbacks
+            << ", check_pending: " << stats.check_pending_time.count() << "ns"
+            << ", lock contentions: " << stats.lock_contentions << std::endl;
+}
@@ -0,0 +1,228 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "requirecpp/requirecpp.hpp"
+
+// Randomized concurrency stress test. Usage:
+//   test_stress [seed] [threads] [operations per thread]
+// Invariants:
+//   - every callback fires at most once, callbacks of the shared context fire
+//     exactly once after all components are published
+//   - threads blocked in require() are all woken up
+//   - no component is used after it was destroyed and none leaks
+
+using namespace std::chrono_literals;
+
+constexpr uint32_t ALIVE = 0xa11fe;
+constexpr uint32_t DEAD = 0xdead;
+
+template <int N>
+struct Payload {
+  Payload() { ++s_created; }
+  ~Payload() {
+    check();
+    magic = DEAD;
+    ++s_destroyed;
+  }
+  void check() const {
+    if (magic != ALIVE) {
+      std::cerr << "use after free of Payload<" << N << ">" << std::endl;
+      std::abort();
+    }
+  }
+  uint32_t magic{ALIVE};
+  static inline std::atomic<uint64_t> s_created{0};
+  static inline std::atomic<uint64_t> s_destroyed{0};
+};
+
+using A = Payload<0>;
+using B = Payload<1>;
+using C = Payload<2>;
+using D = Payload<3>;
+
+// shared by a callback and its guard, tracks that it fires at most once
+struct CallbackState {
+  std::atomic<int> fired{0};
+};
+
+struct Counters {
+  std::atomic<uint64_t> operations{0};
+  std::atomic<uint64_t> registered_shared{0};
+  std::atomic<uint64_t> fired_shared{0};
+  std::atomic<uint64_t> registered_local{0};
+  std::atomic<uint64_t> fired_local{0};
+};
+
+template <typename... Ts>
+void require_once(requirecpp::Context& context,
+                  std::atomic<uint64_t>& registered,
+                  std::atomic<uint64_t>& fired) {
+  auto state = std::make_shared<CallbackState>();
+  ++registered;
+  context.require(
+      [state, &fired](std::shared_ptr<Ts>... objects) {
+        (objects->check(), ...);
+        if (state->fired.fetch_add(1) != 0) {
+          std::cerr << "callback fired twice" << std::endl;
+          std::abort();
+        }
+        ++fired;
+      },
+      "stress");
+}
+
+template <typename T>
+void random_op(requirecpp::Context& context,
+               std::mt19937& rng,
+               std::atomic<uint64_t>& registered,
+               std::atomic<uint64_t>& fired) {
+  switch (rng() % 8) {
+    case 0:
+      context.emplace<T>();
+      break;
+    case 1:
+      context.push(std::make_shared<T>());
+      break;
+    case 2:
+      if (auto p = context.remove<T>())
+        p->check();
+      break;
+    case 3:
+      require_once<T>(context, registered, fired);
+      break;
+    case 4:
+      require_once<A, B, C>(context, registered, fired);
+      break;
+    case 5:
+      if (auto p = context.get<T>()->optional())
+        p->check();
+      break;
+    case 6:
+      try {
+        context.get<T>()->require_for(std::chrono::microseconds{rng() % 100})
+            ->check();
+      } catch (const std::runtime_error&) {
+        // timeout or removed while waiting
+      }
+      break;
+    default:
+      if (auto [a, b, c] = context.get_all<A, B, C>(); a && b && c) {
+        a->check();
+        b->check();
+        c->check();
+      }
+      break;
+  }
+}
+
+void worker(requirecpp::Context& shared,
+            Counters& counters,
+            uint32_t seed,
+            int operations) {
+  std::mt19937 rng{seed};
+  auto local = std::make_unique<requirecpp::Context>();
+  for (int i = 0; i < operations; ++i) {
+    const bool use_shared = rng() % 2 == 0;
+    auto& context = use_shared ? shared : *local;
+    auto& registered =
+        use_shared ? counters.registered_shared : counters.registered_local;
+    auto& fired = use_shared ? counters.fired_shared : counters.fired_local;
+    switch (rng() % 3) {
+      case 0:
+        random_op<A>(context, rng, registered, fired);
+        break;
+      case 1:
+        random_op<B>(context, rng, registered, fired);
+        break;
+      default:
+        random_op<C>(context, rng, registered, fired);
+        break;
+    }
+    // destroy contexts with pending callbacks and blocked lookups
+    if (rng() % 64 == 0) {
+      local = std::make_unique<requirecpp::Context>();
+    }
+    ++counters.operations;
+  }
+}
+
+bool no_lost_wakeups(int waiters) {
+  requirecpp::Context context;
+  std::atomic<int> woken{0};
+  std::atomic<int> blocked{0};
+  {
+    std::vector<std::jthread> threads;
+    for (int i = 0; i < waiters; ++i) {
+      threads.emplace_back([&] {
+        auto d = context.get<D>();
+        ++blocked;
+        d->require_for(10s)->check();
+        ++woken;
+      });
+    }
+    while (blocked < waiters) {
+      std::this_thread::yield();
+    }
+    context.emplace<D>();
+  }
+  return woken == waiters;
+}
+
+int main(int argc, char** argv) {
+  const uint32_t seed = argc > 1 ? std::stoul(argv[1]) : std::random_device{}();
+  const int threads = argc > 2 ? std::stoi(argv[2]) : 8;
+  const int operations = argc > 3 ? std::stoi(argv[3]) : 2000;
+  std::cout << "seed " << seed << ", " << threads << " threads, "
+            << operations << " operations per thread" << std::endl;
+
+  Counters counters;
+  const auto start = std::chrono::steady_clock::now();
+  {
+    requirecpp::Context shared;
+    {
+      std::vector<std::jthread> workers;
+      for (int t = 0; t < threads; ++t) {
+        workers.emplace_back(worker, std::ref(shared), std::ref(counters),
+                             seed + t, operations);
+      }
+    }
+    // all pending callbacks of the shared context must fire now
+    shared.emplace<A>();
+    shared.emplace<B>();
+    shared.emplace<C>();
+    if (counters.fired_shared != counters.registered_shared) {
+      std::cerr << "lost callbacks: " << counters.registered_shared << " / "
+                << counters.fired_shared << std::endl;
+      return 1;
+    }
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  if (counters.fired_local > counters.registered_local) {
+    std::cerr << "local callbacks fired too often" << std::endl;
+    return 1;
+  }
+  if (!no_lost_wakeups(threads * 4)) {
+    std::cerr << "lost wakeup" << std::endl;
+    return 1;
+  }
+  if (A::s_created != A::s_destroyed || B::s_created != B::s_destroyed ||
+      C::s_created != C::s_destroyed || D::s_created != D::s_destroyed) {
+    std::cerr << "leaked components" << std::endl;
+    return 1;
+  }
+
+  const double seconds = std::chrono::duration<double>(elapsed).count();
+  std::cout << counters.operations << " operations in " << seconds << "s, "
+            << static_cast<uint64_t>(counters.operations / seconds)
+            << " ops/s, " << counters.fired_shared + counters.fired_local
+            << " callbacks fired" << std::endl;
+}
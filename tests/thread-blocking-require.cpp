@@ -1,4 +1,5 @@
 #include <barrier>
+#include <cassert>
 #include <iostream>
 #include <thread>
 #include "requirecpp/requirecpp.hpp"
@@ -42,4 +43,18 @@ int main() {
     // it is safe to destruct context, while a requirement is blocking
     context.reset();
   }
+  {
+    // fail() only stops blocking calls, the object stays published
+    requirecpp::Context context;
+    context.emplace<Clazz1>();
+    bool called = false;
+    context.require([&](const Clazz1&, const Clazz2&) { called = true; });
+    context.get<Clazz1>()->fail();
+    assert(context.get<Clazz1>()->has_value());
+    assert(context.exists<Clazz1>());
+    context.emplace<Clazz2>();
+    assert(called);
+    assert(context.stats().objects == 2);
+    assert(context.pending_view().callbacks.empty());
+  }
 }
@@ -0,0 +1,85 @@
+#include <cassert>
+#include <iostream>
+#include <stop_token>
+#include <thread>
+#include "requirecpp/requirecpp.hpp"
+
+using namespace std::chrono_literals;
+
+class Db {};
+class Metrics {};
+
+int main() {
+  {
+    requirecpp::Context context;
+    bool timed_out = false;
+    try {
+      context.get<Db>()->require_for(10ms);
+    } catch (const std::exception& e) {
+      std::cout << "require_for: " << e.what() << std::endl;
+      timed_out = true;
+    }
+    assert(timed_out);
+
+    std::jthread publisher{[&] { context.emplace<Db>(); }};
+    assert(context.get<Db>()->require_until(std::chrono::system_clock::now() +
+                                            10s) != nullptr);
+  }
+  {
+    requirecpp::Context context;
+    std::stop_source stop;
+    std::jthread canceller{[&] {
+      std::this_thread::sleep_for(10ms);
+      stop.request_stop();
+    }};
+    bool cancelled = false;
+    try {
+      context.get<Db>()->require(stop.get_token());
+    } catch (const std::exception& e) {
+      std::cout << "require(stop_token): " << e.what() << std::endl;
+      cancelled = true;
+    }
+    assert(cancelled);
+  }
+  {
+    requirecpp::Context context;
+    std::string missing;
+    bool called = false;
+    context.require_for([&](const Db&, const Metrics&) { called = true; }, 0s,
+                        [&](const std::string& decl) { missing = decl; },
+                        "expired");
+    context.require_for([&](const Db&) { called = true; }, 1h,
+                        [&](const std::string&) { assert(false); }, "in time");
+    context.emplace<Db>();
+    std::cout << "timed out: " << missing << std::endl;
+    assert(missing.find("Metrics [missing]") != std::string::npos);
+    assert(called);
+    context.emplace<Metrics>();
+    context.expire_pending();
+    assert(context.list_pending().empty());
+  }
+  {
+    // an idle context times out when a timer at next_deadline() fires
+    requirecpp::Context context;
+    assert(!context.next_deadline().has_value());
+    const auto deadline = std::chrono::steady_clock::now() + 20ms;
+    bool timed_out = false;
+    context.require_until(
+        [](const Db&) { assert(false); }, deadline,
+        [&](const std::string&) {
+          // runs without the context lock, other threads can use the context
+          std::jthread other{[&] { context.emplace<Metrics>(); }};
+          other.join();
+          timed_out = true;
+        },
+        "idle");
+    context.require_for([](const Db&) {}, 1h, [](const std::string&) {},
+                        "later");
+    assert(context.next_deadline() == deadline);
+    std::this_thread::sleep_until(*context.next_deadline());
+    context.expire_pending();
+    assert(timed_out);
+    assert(context.exists<Metrics>());
+    assert(context.next_deadline() > deadline);
+  }
+}